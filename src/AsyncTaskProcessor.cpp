@@ -1,6 +1,7 @@
 #include "AsyncTaskProcessor.h"
 #include "Log.h"
 
+#include <chrono>
 #include <exception>
 
 
@@ -17,17 +18,11 @@ AsyncTaskProcessor::~AsyncTaskProcessor()
 
 void AsyncTaskProcessor::startTask(std::function<void()> f)
 {
+	++m_tasksStarted;
+
 	if (m_synchronous) {
 		// 同步执行
-		try {
-			f();
-		}
-		catch (const std::exception& e) {
-			CO_CRITICAL("Synchronous task execution failed: {}", e.what());
-		}
-		catch (...) {
-			CO_CRITICAL("Synchronous task execution failed with unknown exception");
-		}
+		runTask(f);
 	}
 	else {
 		// 异步执行
@@ -37,9 +32,7 @@ void AsyncTaskProcessor::startTask(std::function<void()> f)
 		}
 
 		// 确保工作线程已启动
-		if (!m_workerThread.joinable() && !m_shutdown) {
-			startWorkerThread();
-		}
+		startWorkerThread();
 
 		m_condition.notify_one();
 	}
@@ -47,8 +40,9 @@ void AsyncTaskProcessor::startTask(std::function<void()> f)
 
 void AsyncTaskProcessor::startWorkerThread()
 {
-	if (!m_workerThread.joinable() && !m_shutdown) {
-		m_workerThread = std::thread(&AsyncTaskProcessor::workerThreadFunction, this);
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+	while (m_workerThreads.size() < m_workerThreadCount && !m_shutdown) {
+		m_workerThreads.emplace_back(&AsyncTaskProcessor::workerThreadFunction, this);
 	}
 }
 
@@ -57,8 +51,10 @@ void AsyncTaskProcessor::stopWorkerThread()
 	m_shutdown = true;
 	m_condition.notify_all();
 
-	if (m_workerThread.joinable()) {
-		m_workerThread.join();
+	for (std::thread& workerThread : m_workerThreads) {
+		if (workerThread.joinable()) {
+			workerThread.join();
+		}
 	}
 }
 
@@ -82,15 +78,37 @@ void AsyncTaskProcessor::workerThreadFunction()
 		}
 
 		if (task) {
-			try {
-				task();
-			}
-			catch (const std::exception& e) {
-				CO_CRITICAL("Asynchronous task execution failed: {}", e.what());
-			}
-			catch (...) {
-				CO_CRITICAL("Asynchronous task execution failed with unknown exception");
-			}
+			runTask(task);
 		}
 	}
 }
+
+void AsyncTaskProcessor::runTask(const std::function<void()>& task)
+{
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		task();
+	}
+	catch (const std::exception& e) {
+		CO_CRITICAL("Task execution failed: {}", e.what());
+	}
+	catch (...) {
+		CO_CRITICAL("Task execution failed with unknown exception");
+	}
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	m_busyMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	++m_tasksCompleted;
+}
+
+AsyncTaskProcessor::Statistics AsyncTaskProcessor::getStatistics()
+{
+	Statistics statistics;
+	statistics.tasksStarted = m_tasksStarted;
+	statistics.tasksCompleted = m_tasksCompleted;
+	statistics.busyTime = m_busyMicroseconds * 1e-6;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		statistics.tasksQueued = m_taskQueue.size();
+	}
+	return statistics;
+}
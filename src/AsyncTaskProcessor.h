@@ -9,6 +9,8 @@
 #include <condition_variable>
 #include <queue>
 #include <atomic>
+#include <cstdint>
+#include <vector>
 
 // 前向声明
 namespace spdlog {
@@ -32,6 +34,23 @@ public:
     void setSynchronous(bool sync) { m_synchronous = sync; }
     bool isSynchronous() const { return m_synchronous; }
 
+    // Set the number of worker threads used in asynchronous mode (default 1).
+    // Threads are started lazily; lowering the count does not stop running threads.
+    void setWorkerThreadCount(unsigned int count) { m_workerThreadCount = count > 0 ? count : 1; }
+    unsigned int getWorkerThreadCount() const { return m_workerThreadCount; }
+
+    struct Statistics
+    {
+        uint64_t tasksStarted = 0;
+        uint64_t tasksCompleted = 0;
+        // Tasks waiting in the queue (asynchronous mode only)
+        size_t tasksQueued = 0;
+        // Total time spent executing tasks, in seconds
+        double busyTime = 0.0;
+    };
+
+    Statistics getStatistics();
+
 private:
 	std::shared_ptr<spdlog::logger> m_logger;
 
@@ -39,11 +58,17 @@ private:
     
     // For async mode (if needed)
     std::atomic<bool> m_shutdown{false};
-    std::thread m_workerThread;
+    std::atomic<unsigned int> m_workerThreadCount{1};
+    std::vector<std::thread> m_workerThreads;
     std::mutex m_queueMutex;
     std::condition_variable m_condition;
     std::queue<std::function<void()>> m_taskQueue;
     
+    std::atomic<uint64_t> m_tasksStarted{0};
+    std::atomic<uint64_t> m_tasksCompleted{0};
+    std::atomic<uint64_t> m_busyMicroseconds{0};
+
+    void runTask(const std::function<void()>& task);
     void workerThreadFunction();
     void startWorkerThread();
     void stopWorkerThread();
@@ -0,0 +1,238 @@
+#include "CacheBudgetManager.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 超过该帧数没有报告的瓦片集视为不可见
+		constexpr unsigned int STALE_FRAMES = 10;
+		// 瓦片集需要的预算：当前占用加上继续加载的增长空间
+		constexpr double GROWTH = 1.25;
+		constexpr int64_t GROWTH_BYTES = 32 * 1024 * 1024;
+		// 预算变化小于该比例时不回调
+		constexpr double CHANGE_THRESHOLD = 0.01;
+	}
+
+	CacheBudgetManager::CacheBudgetManager(int64_t totalBytes)
+		: m_totalBytes(std::max<int64_t>(0, totalBytes))
+	{
+	}
+
+	void CacheBudgetManager::setTotalBytes(int64_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		bytes = std::max<int64_t>(0, bytes);
+		if (bytes != m_totalBytes) {
+			m_totalBytes = bytes;
+			m_dirty = true;
+		}
+	}
+
+	int64_t CacheBudgetManager::getTotalBytes() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_totalBytes;
+	}
+
+	void CacheBudgetManager::setMinimumBytes(int64_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_minimumBytes = std::max<int64_t>(0, bytes);
+		m_dirty = true;
+	}
+
+	int64_t CacheBudgetManager::getMinimumBytes() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_minimumBytes;
+	}
+
+	int64_t CacheBudgetManager::getUsedBytes() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		int64_t bytes = 0;
+		for (const auto& [tileset, entry] : m_entries) {
+			bytes += entry.usedBytes;
+		}
+		return bytes;
+	}
+
+	void CacheBudgetManager::addTileset(const void* tileset, BudgetCallback callback)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_entries[tileset].callback = std::move(callback);
+		m_dirty = true;
+	}
+
+	void CacheBudgetManager::removeTileset(const void* tileset)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_entries.erase(tileset) > 0) {
+			m_dirty = true;
+		}
+	}
+
+	CacheBudgetManager::TilesetBudget CacheBudgetManager::getBudget(const void* tileset) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		TilesetBudget result;
+		auto itr = m_entries.find(tileset);
+		if (itr != m_entries.end()) {
+			result.contribution = itr->second.contribution;
+			result.usedBytes = itr->second.usedBytes;
+			result.budget = itr->second.budget;
+		}
+		return result;
+	}
+
+	void CacheBudgetManager::update(const void* tileset, unsigned int frameNumber, double contribution, int64_t usedBytes)
+	{
+		std::vector<Notification> notifications;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto itr = m_entries.find(tileset);
+			if (itr == m_entries.end()) {
+				return;
+			}
+			Entry& entry = itr->second;
+			entry.contribution = std::max(0.0, contribution);
+			entry.usedBytes = std::max<int64_t>(0, usedBytes);
+			entry.frameNumber = frameNumber;
+			entry.reported = true;
+			entry.trimmedSinceReport = false;
+
+			if (m_dirty || frameNumber != m_lastFrameNumber) {
+				notifications = rebalance(frameNumber);
+			}
+		}
+
+		// 回调中会修改瓦片集的缓存预算甚至立即淘汰瓦片，在锁外进行
+		for (const Notification& notification : notifications) {
+			notification.callback(notification.budget, notification.updated);
+		}
+	}
+
+	std::vector<CacheBudgetManager::Notification> CacheBudgetManager::rebalance(unsigned int frameNumber)
+	{
+		m_lastFrameNumber = frameNumber;
+		m_dirty = false;
+
+		std::vector<Notification> notifications;
+		if (m_entries.empty()) {
+			return notifications;
+		}
+
+		struct Allocation
+		{
+			const void* tileset;
+			Entry* entry;
+			double contribution;
+			int64_t demand;
+			int64_t budget;
+			bool capped;
+		};
+
+		const int64_t count = static_cast<int64_t>(m_entries.size());
+		const int64_t floorBytes = std::min(m_minimumBytes, m_totalBytes / count);
+		int64_t remaining = m_totalBytes - floorBytes * count;
+
+		std::vector<Allocation> allocations;
+		allocations.reserve(m_entries.size());
+		double totalContribution = 0.0;
+		for (auto& [tileset, entry] : m_entries) {
+			// 长时间没有报告的瓦片集（隐藏或已移出视野）只保留保底预算
+			const bool stale = !entry.reported || entry.frameNumber + STALE_FRAMES < frameNumber;
+			const double contribution = stale ? 0.0 : entry.contribution;
+			const int64_t demand = std::max<int64_t>(0,
+				static_cast<int64_t>(entry.usedBytes * GROWTH) + GROWTH_BYTES - floorBytes);
+			allocations.push_back({ tileset, &entry, contribution, demand, floorBytes, false });
+			totalContribution += contribution;
+		}
+
+		if (totalContribution > 0.0) {
+			// 按贡献比例分配剩余预算，份额超过需要的瓦片集只拿需要的部分，多出的部分在其余瓦片集中重新分配
+			bool capped = true;
+			while (capped && remaining > 0 && totalContribution > 0.0) {
+				capped = false;
+				for (Allocation& allocation : allocations) {
+					if (allocation.capped || allocation.contribution <= 0.0) {
+						continue;
+					}
+					const double share = remaining * (allocation.contribution / totalContribution);
+					if (share >= static_cast<double>(allocation.demand)) {
+						allocation.budget += allocation.demand;
+						allocation.capped = true;
+						remaining -= allocation.demand;
+						totalContribution -= allocation.contribution;
+						capped = true;
+					}
+				}
+			}
+
+			if (totalContribution > 0.0) {
+				for (Allocation& allocation : allocations) {
+					if (!allocation.capped && allocation.contribution > 0.0) {
+						allocation.budget += static_cast<int64_t>(remaining * (allocation.contribution / totalContribution));
+					}
+				}
+			}
+			else if (remaining > 0) {
+				// 所有可见瓦片集的需要都已满足，余量按贡献比例再分给它们，允许继续细化
+				double visibleContribution = 0.0;
+				for (const Allocation& allocation : allocations) {
+					visibleContribution += allocation.contribution;
+				}
+				for (Allocation& allocation : allocations) {
+					allocation.budget += static_cast<int64_t>(remaining * (allocation.contribution / visibleContribution));
+				}
+			}
+		}
+		else {
+			// 没有任何瓦片集可见时平分
+			for (Allocation& allocation : allocations) {
+				allocation.budget += remaining / count;
+			}
+		}
+
+		// 价值（贡献 / 占用）最低的瓦片集先回调，先淘汰
+		std::sort(allocations.begin(), allocations.end(), [](const Allocation& a, const Allocation& b) {
+			return a.contribution / std::max<int64_t>(1, a.entry->usedBytes) < b.contribution / std::max<int64_t>(1, b.entry->usedBytes);
+		});
+
+		for (const Allocation& allocation : allocations) {
+			Entry& entry = *allocation.entry;
+			// 刚加入、还没有报告过的瓦片集暂时保留自己的预算
+			if (!entry.reported) {
+				continue;
+			}
+			// 上一帧以来报告过的瓦片集会在自己的选择中淘汰，预算变化时才回调；
+			// 其余的（不再遍历）由回调自行淘汰，预算变化、或报告之后首次超出预算时回调一次
+			const bool updated = entry.frameNumber + 1 >= frameNumber;
+			const int64_t change = std::abs(allocation.budget - entry.budget);
+			const bool changed = entry.budget <= 0 || change > static_cast<int64_t>(entry.budget * CHANGE_THRESHOLD);
+			if (updated && !changed) {
+				continue;
+			}
+			if (!updated) {
+				const bool overBudget = entry.usedBytes > allocation.budget && !entry.trimmedSinceReport;
+				if (!changed && !overBudget) {
+					continue;
+				}
+				entry.trimmedSinceReport = true;
+			}
+			if (allocation.budget < entry.usedBytes) {
+				CO_DEBUG("Shared cache budget: tileset {} shrinks to {} MB ({} MB used, contribution {:.3f})",
+					allocation.tileset, allocation.budget >> 20, entry.usedBytes >> 20, allocation.contribution);
+			}
+			entry.budget = allocation.budget;
+			notifications.push_back({ entry.callback, entry.budget, updated });
+		}
+		return notifications;
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 在多个瓦片集之间分配同一个缓存预算
+	 * 每个瓦片集每帧报告自己的屏幕贡献（可见瓦片覆盖的屏幕比例）和实际占用的字节数。
+	 * 每帧重新分配一次：每个瓦片集先得到一个保底预算，剩余部分按屏幕贡献的比例分配；
+	 * 份额超过需要（当前占用加增长空间）的部分转给其它瓦片集。长时间没有报告的瓦片集（不可见、未遍历）贡献视为 0。
+	 * 预算变化时按价值（贡献 / 占用）从低到高回调各瓦片集，价值最低的瓦片集最先收缩并淘汰瓦片；
+	 * 不再报告的瓦片集只在预算变化、或报告之后首次超出预算时回调，不会每帧回调。
+	 */
+	class CacheBudgetManager
+	{
+	public:
+		// 预算变化时的回调；updated 表示该瓦片集最近一帧报告过，为 false 时瓦片集不再被遍历，需要在回调中自行淘汰
+		using BudgetCallback = std::function<void(int64_t budget, bool updated)>;
+
+		struct TilesetBudget
+		{
+			double contribution = 0.0;
+			int64_t usedBytes = 0;
+			int64_t budget = 0;
+		};
+
+		explicit CacheBudgetManager(int64_t totalBytes = 1024 * 1024 * 1024);
+
+		// 设置和获取所有瓦片集共享的预算
+		void setTotalBytes(int64_t bytes);
+		int64_t getTotalBytes() const;
+
+		// 设置和获取每个瓦片集的保底预算（瓦片集过多时按总预算平分）
+		void setMinimumBytes(int64_t bytes);
+		int64_t getMinimumBytes() const;
+
+		// 获取所有瓦片集最近报告的占用之和
+		int64_t getUsedBytes() const;
+
+		// 加入和移除瓦片集
+		void addTileset(const void* tileset, BudgetCallback callback);
+		void removeTileset(const void* tileset);
+
+		// 每帧由瓦片集在更新遍历中调用，每帧第一次调用时重新分配预算
+		void update(const void* tileset, unsigned int frameNumber, double contribution, int64_t usedBytes);
+
+		// 获取瓦片集当前的分配结果
+		TilesetBudget getBudget(const void* tileset) const;
+
+	private:
+		struct Entry
+		{
+			BudgetCallback callback;
+			double contribution = 0.0;
+			int64_t usedBytes = 0;
+			int64_t budget = 0;
+			unsigned int frameNumber = 0;
+			bool reported = false;
+			// 最近一次报告之后，是否已经以当前预算回调过不再遍历的瓦片集（不遍历时占用不会增长，淘汰一次即可）
+			bool trimmedSinceReport = false;
+		};
+
+		struct Notification
+		{
+			BudgetCallback callback;
+			int64_t budget = 0;
+			bool updated = false;
+		};
+
+		// 重新分配预算，返回预算有变化的瓦片集（按价值从低到高排列）
+		std::vector<Notification> rebalance(unsigned int frameNumber);
+
+		mutable std::mutex m_mutex;
+		int64_t m_totalBytes;
+		int64_t m_minimumBytes = 16 * 1024 * 1024;
+		std::unordered_map<const void*, Entry> m_entries;
+		unsigned int m_lastFrameNumber = 0;
+		bool m_dirty = true;
+	};
+
+}	// namespace czmosg
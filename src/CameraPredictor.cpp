@@ -0,0 +1,90 @@
+#include "CameraPredictor.h"
+
+#include <osg/Quat>
+
+#include <algorithm>
+#include <cmath>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 速度指数平滑系数，抑制逐帧抖动
+		constexpr double SMOOTHING = 0.3;
+		// 两次采样间隔超过该值（秒）时认为运动已中断，重新开始估计
+		constexpr double MAX_SAMPLE_INTERVAL = 0.5;
+		// 线速度（米/秒）和角速度（弧度/秒）低于该值时视为静止
+		constexpr double MIN_SPEED = 0.01;
+		constexpr double MIN_ANGULAR_SPEED = 1e-4;
+
+		// 从 from 旋转到 to 的角速度向量（轴 * 角度 / dt）
+		osg::Vec3d angularVelocityBetween(const osg::Vec3d& from, const osg::Vec3d& to, double dt)
+		{
+			osg::Vec3d axis = from ^ to;
+			const double sinAngle = axis.length();
+			const double cosAngle = std::clamp(from * to, -1.0, 1.0);
+			if (sinAngle < 1e-12) {
+				return osg::Vec3d();
+			}
+			axis /= sinAngle;
+			return axis * (std::atan2(sinAngle, cosAngle) / dt);
+		}
+	}
+
+	void CameraPredictor::addSample(uint64_t viewId, double time, const Pose& pose)
+	{
+		auto [itr, inserted] = m_views.try_emplace(viewId);
+		Motion& motion = itr->second;
+
+		const double dt = time - motion.time;
+		if (!inserted && dt > 0.0 && dt <= MAX_SAMPLE_INTERVAL) {
+			const osg::Vec3d velocity = (pose.eye - motion.pose.eye) / dt;
+			const osg::Vec3d angularVelocity = angularVelocityBetween(motion.pose.direction, pose.direction, dt);
+			if (motion.hasVelocity) {
+				motion.velocity += (velocity - motion.velocity) * SMOOTHING;
+				motion.angularVelocity += (angularVelocity - motion.angularVelocity) * SMOOTHING;
+			}
+			else {
+				motion.velocity = velocity;
+				motion.angularVelocity = angularVelocity;
+				motion.hasVelocity = true;
+			}
+		}
+		else if (dt != 0.0) {
+			motion.hasVelocity = false;
+			motion.velocity = osg::Vec3d();
+			motion.angularVelocity = osg::Vec3d();
+		}
+
+		motion.time = time;
+		motion.pose = pose;
+	}
+
+	bool CameraPredictor::predict(uint64_t viewId, double lookahead, Pose& pose) const
+	{
+		auto itr = m_views.find(viewId);
+		if (itr == m_views.end() || !itr->second.hasVelocity) {
+			return false;
+		}
+
+		const Motion& motion = itr->second;
+		const double angularSpeed = motion.angularVelocity.length();
+		if (motion.velocity.length() < MIN_SPEED && angularSpeed < MIN_ANGULAR_SPEED) {
+			return false;
+		}
+
+		pose.eye = motion.pose.eye + motion.velocity * lookahead;
+		pose.direction = motion.pose.direction;
+		pose.up = motion.pose.up;
+		if (angularSpeed >= MIN_ANGULAR_SPEED) {
+			const osg::Quat rotation(angularSpeed * lookahead, motion.angularVelocity / angularSpeed);
+			pose.direction = rotation * pose.direction;
+			pose.up = rotation * pose.up;
+		}
+		pose.direction.normalize();
+		pose.up.normalize();
+		return true;
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <osg/Vec3d>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 根据相机最近的运动外推未来的位置和朝向，用于预取相机即将看到的瓦片
+	 * 每个视图（按调用方分配的、不会复用的视图编号区分）记录平滑后的线速度和角速度（绕某一轴的旋转速率），
+	 * predict() 假设相机在预测时间内保持匀速直线运动和匀速旋转。
+	 */
+	class CameraPredictor
+	{
+	public:
+		struct Pose
+		{
+			osg::Vec3d eye;
+			osg::Vec3d direction;
+			osg::Vec3d up;
+		};
+
+		// 记录视图在 time（秒）时的位姿
+		void addSample(uint64_t viewId, double time, const Pose& pose);
+
+		// 外推视图在最近一次采样之后 lookahead 秒的位姿；没有足够的历史或相机静止时返回 false
+		bool predict(uint64_t viewId, double lookahead, Pose& pose) const;
+
+		// 移除不再使用的视图
+		void removeView(uint64_t viewId) { m_views.erase(viewId); }
+
+	private:
+		struct Motion
+		{
+			double time = 0.0;
+			Pose pose;
+			bool hasVelocity = false;
+			osg::Vec3d velocity;
+			// 旋转轴乘以角速度（弧度/秒）
+			osg::Vec3d angularVelocity;
+		};
+
+		std::unordered_map<uint64_t, Motion> m_views;
+	};
+
+}	// namespace czmosg
@@ -1,7 +1,14 @@
 #include "Cesium3DTileset.h"
 #include "AsyncTaskProcessor.h"
+#include "CacheBudgetManager.h"
+#include "CameraPredictor.h"
+#include "LoadConcurrencyTuner.h"
+#include "MemoryGovernor.h"
+#include "ScreenSpaceErrorController.h"
 #include "SimpleAssetAccessor.h"
 #include "SimpleRenderResourcesPreparer.h"
+#include "TileBatcher.h"
+#include "RuntimeSupport.h"
 #include "Log.h"
 
 #include <Cesium3DTilesContent/registerAllTileContentTypes.h>
@@ -26,82 +33,750 @@
 #include <CesiumGltf/Model.h>
 #include <CesiumGltf/AccessorView.h>
 #include <CesiumGltf/ImageAsset.h>
+#include <CesiumGeometry/BoundingSphere.h>
+#include <CesiumGeometry/OrientedBoundingBox.h>
 
 #include <osgUtil/CullVisitor>
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 
-// 确保仅注册一次所有3D Tiles内容类型
-static void ensureTileContentTypesRegistered()
+// 确保仅注册一次所有3D Tiles内容类型
+static void ensureTileContentTypesRegistered()
+{
+	static bool s_registered = false;
+	if (!s_registered) {
+		Cesium3DTilesContent::registerAllTileContentTypes();
+		CO_TRACE("Registered all Cesium 3D Tiles content types");
+		s_registered = true;
+	}
+}
+
+// 同步模式下加载任务在调用线程中逐个执行，提高并发数只会让一帧内串行执行更多加载，保持保守的 1/1 限制；
+// 异步模式下使用 cesium-native 的默认值
+static void applyLoadLimits(Cesium3DTilesSelection::TilesetOptions& options, bool synchronous)
+{
+	const Cesium3DTilesSelection::TilesetOptions defaults;
+	options.maximumSimultaneousTileLoads = synchronous ? 1 : defaults.maximumSimultaneousTileLoads;
+	options.loadingDescendantLimit = synchronous ? 1 : defaults.loadingDescendantLimit;
+}
+
+// 获取瓦片在主线程中准备好的渲染资源，没有渲染内容时返回 nullptr
+static const MainThreadResult* getTileResult(const Cesium3DTilesSelection::Tile& tile)
+{
+	const Cesium3DTilesSelection::TileRenderContent* renderContent = tile.getContent().getRenderContent();
+	if (!renderContent) {
+		return nullptr;
+	}
+	return reinterpret_cast<const MainThreadResult*>(renderContent->getRenderResources());
+}
+
+// 瓦片包围体的外接球：球直接使用，其它类型（有向包围盒、region 等）转换为有向包围盒后取外接球
+static osg::BoundingSphered getTileBoundingSphere(const Cesium3DTilesSelection::BoundingVolume& boundingVolume)
+{
+	const CesiumGeometry::BoundingSphere* pSphere = std::get_if<CesiumGeometry::BoundingSphere>(&boundingVolume);
+	const CesiumGeometry::BoundingSphere sphere = pSphere
+		? *pSphere
+		: Cesium3DTilesSelection::getOrientedBoundingBoxFromBoundingVolume(boundingVolume).toSphere();
+	const glm::dvec3& center = sphere.getCenter();
+	return osg::BoundingSphered(osg::Vec3d(center.x, center.y, center.z), sphere.getRadius());
+}
+
+// 包围球在视图中覆盖的屏幕比例（按投影圆面积与视野面积之比估算，最多为 1），支持透视（含非对称视锥体）和正交投影
+static double computeScreenCoverage(const osg::BoundingSphered& sphere, const osg::Vec3d& eye, const osg::Matrixd& projection)
+{
+	const double radius2 = sphere.radius() * sphere.radius();
+	double left, right, bottom, top, zNear, zFar;
+	if (projection.getOrtho(left, right, bottom, top, zNear, zFar)) {
+		const double viewArea = (right - left) * (top - bottom);
+		return viewArea > 0.0 ? std::min(1.0, osg::PI * radius2 / viewArea) : 0.0;
+	}
+	if (projection.getFrustum(left, right, bottom, top, zNear, zFar) && zNear > 0.0) {
+		const double distance2 = (sphere.center() - eye).length2();
+		if (distance2 <= radius2) {
+			return 1.0;
+		}
+		// 视锥体在单位距离处的截面积
+		const double viewArea = (right - left) * (top - bottom) / (zNear * zNear);
+		const double sphereArea = osg::PI * radius2 / (distance2 - radius2);
+		return viewArea > 0.0 ? std::min(1.0, sphereArea / viewArea) : 0.0;
+	}
+	return 0.0;
+}
+
+// 在容差范围内是否为同一投影；近远平面相关的两项不参与比较（开启近远平面计算时 OSG 每帧都会修改）
+static bool isSameProjection(const osg::Matrixd& a, const osg::Matrixd& b)
+{
+	for (int row = 0; row < 4; ++row) {
+		for (int column = 0; column < 4; ++column) {
+			if (column == 2 && row >= 2) {
+				continue;
+			}
+			if (std::abs(a(row, column) - b(row, column)) > 1e-9 * std::max(1.0, std::abs(a(row, column)))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+Cesium3DTileset::Cesium3DTileset(const std::string& url, float maximumScreenSpaceError)
+	: m_tileset(nullptr)
+{
+	ensureTileContentTypesRegistered();
+	initializeTileset(url, maximumScreenSpaceError);
+	setCullingActive(false);
+	m_sseController = std::make_shared<czmosg::ScreenSpaceErrorController>();
+	m_loadConcurrencyTuner = std::make_shared<czmosg::LoadConcurrencyTuner>();
+	m_cameraPredictor = std::make_shared<czmosg::CameraPredictor>();
+	m_memoryGovernor = std::make_shared<czmosg::MemoryGovernor>();
+	// 瓦片选择在更新遍历中进行，需要接收更新遍历
+	setNumChildrenRequiringUpdateTraversal(getNumChildrenRequiringUpdateTraversal() + 1);
+}
+
+Cesium3DTileset::Cesium3DTileset(unsigned int assetID, const std::string& server, const std::string& token, float maximumScreenSpaceError)
+	: m_tileset(nullptr)
+{
+	ensureTileContentTypesRegistered();
+	initializeTileset(assetID, server, token, maximumScreenSpaceError);
+	setCullingActive(false);
+	m_sseController = std::make_shared<czmosg::ScreenSpaceErrorController>();
+	m_loadConcurrencyTuner = std::make_shared<czmosg::LoadConcurrencyTuner>();
+	m_cameraPredictor = std::make_shared<czmosg::CameraPredictor>();
+	m_memoryGovernor = std::make_shared<czmosg::MemoryGovernor>();
+	// 瓦片选择在更新遍历中进行，需要接收更新遍历
+	setNumChildrenRequiringUpdateTraversal(getNumChildrenRequiringUpdateTraversal() + 1);
+}
+
+Cesium3DTileset::~Cesium3DTileset()
+{
+	if (m_cacheBudgetManager) {
+		m_cacheBudgetManager->removeTileset(this);
+	}
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		delete tileset;
+	}
+}
+
+
+float Cesium3DTileset::getMaximumScreenSpaceError() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().maximumScreenSpaceError;
+	}
+	return 16.0f;
+}
+
+void Cesium3DTileset::setMaximumScreenSpaceError(float error)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().maximumScreenSpaceError = error;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getAdaptiveScreenSpaceError() const
+{
+	return m_adaptiveScreenSpaceError;
+}
+
+void Cesium3DTileset::setAdaptiveScreenSpaceError(bool adaptive)
+{
+	if (adaptive && !m_adaptiveScreenSpaceError) {
+		m_sseController->reset();
+	}
+	m_adaptiveScreenSpaceError = adaptive;
+}
+
+void Cesium3DTileset::setScreenSpaceErrorRange(float minimum, float maximum)
+{
+	m_sseController->setRange(minimum, maximum);
+}
+
+float Cesium3DTileset::getMinimumAdaptiveScreenSpaceError() const
+{
+	return m_sseController->getMinimum();
+}
+
+float Cesium3DTileset::getMaximumAdaptiveScreenSpaceError() const
+{
+	return m_sseController->getMaximum();
+}
+
+double Cesium3DTileset::getTargetFrameRate() const
+{
+	return m_sseController->getTargetFrameRate();
+}
+
+void Cesium3DTileset::setTargetFrameRate(double frameRate)
+{
+	m_sseController->setTargetFrameRate(frameRate);
+}
+
+uint64_t Cesium3DTileset::getTriangleBudget() const
+{
+	return m_sseController->getTriangleBudget();
+}
+
+void Cesium3DTileset::setTriangleBudget(uint64_t triangles)
+{
+	m_sseController->setTriangleBudget(triangles);
+}
+
+uint64_t Cesium3DTileset::getVisibleTriangles() const
+{
+	return m_visibleTriangles;
+}
+
+uint32_t Cesium3DTileset::getLoadQueueLength() const
+{
+	return m_workerThreadLoadQueueLength + m_mainThreadLoadQueueLength;
+}
+
+uint32_t Cesium3DTileset::getMaximumSimultaneousTileLoads() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().maximumSimultaneousTileLoads;
+	}
+	return Cesium3DTilesSelection::TilesetOptions{}.maximumSimultaneousTileLoads;
+}
+
+void Cesium3DTileset::setMaximumSimultaneousTileLoads(uint32_t loads)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().maximumSimultaneousTileLoads = loads;
+		m_selectionDirty = true;
+	}
+}
+
+uint32_t Cesium3DTileset::getMaximumSimultaneousSubtreeLoads() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().maximumSimultaneousSubtreeLoads;
+	}
+	return Cesium3DTilesSelection::TilesetOptions{}.maximumSimultaneousSubtreeLoads;
+}
+
+void Cesium3DTileset::setMaximumSimultaneousSubtreeLoads(uint32_t loads)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().maximumSimultaneousSubtreeLoads = loads;
+		m_selectionDirty = true;
+	}
+}
+
+uint32_t Cesium3DTileset::getLoadingDescendantLimit() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().loadingDescendantLimit;
+	}
+	return Cesium3DTilesSelection::TilesetOptions{}.loadingDescendantLimit;
+}
+
+void Cesium3DTileset::setLoadingDescendantLimit(uint32_t limit)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().loadingDescendantLimit = limit;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getPreloadAncestors() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().preloadAncestors;
+	}
+	return true;
+}
+
+void Cesium3DTileset::setPreloadAncestors(bool preload)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().preloadAncestors = preload;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getPreloadSiblings() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().preloadSiblings;
+	}
+	return true;
+}
+
+void Cesium3DTileset::setPreloadSiblings(bool preload)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().preloadSiblings = preload;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getEnableFrustumCulling() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().enableFrustumCulling;
+	}
+	return true;
+}
+
+void Cesium3DTileset::setEnableFrustumCulling(bool enable)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().enableFrustumCulling = enable;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getEnableFogCulling() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().enableFogCulling;
+	}
+	return true;
+}
+
+void Cesium3DTileset::setEnableFogCulling(bool enable)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().enableFogCulling = enable;
+		m_selectionDirty = true;
+	}
+}
+
+unsigned int Cesium3DTileset::getLoadWorkerThreadCount() const
+{
+	if (m_taskProcessor) {
+		return m_taskProcessor->getWorkerThreadCount();
+	}
+	return 0;
+}
+
+void Cesium3DTileset::setLoadWorkerThreadCount(unsigned int count)
+{
+	if (m_taskProcessor) {
+		m_taskProcessor->setWorkerThreadCount(count);
+	}
+}
+
+bool Cesium3DTileset::getAsynchronousLoading() const
+{
+	return m_taskProcessor && !m_taskProcessor->isSynchronous();
+}
+
+void Cesium3DTileset::setAsynchronousLoading(bool asynchronous)
+{
+	if (!m_taskProcessor || asynchronous == getAsynchronousLoading()) {
+		return;
+	}
+
+	m_taskProcessor->setSynchronous(!asynchronous);
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		applyLoadLimits(tileset->getOptions(), !asynchronous);
+		m_selectionDirty = true;
+	}
+	if (asynchronous && m_autoTuneLoadConcurrency) {
+		m_loadConcurrencyTuner->reset();
+	}
+	CO_INFO("Tile loading switched to {} mode", asynchronous ? "asynchronous" : "synchronous");
+}
+
+bool Cesium3DTileset::getPredictivePrefetch() const
+{
+	return m_predictivePrefetch;
+}
+
+void Cesium3DTileset::setPredictivePrefetch(bool prefetch)
+{
+	m_predictivePrefetch = prefetch;
+	if (!prefetch) {
+		m_prefetchedTiles.clear();
+	}
+	m_selectionDirty = true;
+}
+
+double Cesium3DTileset::getPrefetchLookahead() const
+{
+	return m_prefetchLookahead;
+}
+
+void Cesium3DTileset::setPrefetchLookahead(double seconds)
+{
+	m_prefetchLookahead = std::max(0.0, seconds);
+}
+
+Cesium3DTileset::PrefetchStatistics Cesium3DTileset::getPrefetchStatistics() const
+{
+	return m_prefetchStatistics;
+}
+
+void Cesium3DTileset::resetPrefetchStatistics()
+{
+	m_prefetchStatistics = PrefetchStatistics();
+}
+
+bool Cesium3DTileset::getAutoTuneLoadConcurrency() const
+{
+	return m_autoTuneLoadConcurrency;
+}
+
+void Cesium3DTileset::setAutoTuneLoadConcurrency(bool autoTune)
+{
+	if (autoTune && !m_autoTuneLoadConcurrency) {
+		m_loadConcurrencyTuner->reset();
+	}
+	m_autoTuneLoadConcurrency = autoTune;
+}
+
+void Cesium3DTileset::setLoadConcurrencyRange(uint32_t minimum, uint32_t maximum)
+{
+	m_loadConcurrencyTuner->setRange(minimum, maximum);
+}
+
+void Cesium3DTileset::setMaximumLoadLatency(double latency)
+{
+	m_loadConcurrencyTuner->setMaximumLatency(latency);
+}
+
+double Cesium3DTileset::getMaximumLoadLatency() const
+{
+	return m_loadConcurrencyTuner->getMaximumLatency();
+}
+
+bool Cesium3DTileset::getForbidHoles() const
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		return tileset->getOptions().forbidHoles;
+	}
+	return false;
+}
+
+void Cesium3DTileset::setForbidHoles(bool forbidHoles)
+{
+	if (m_tileset) {
+		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+		tileset->getOptions().forbidHoles = forbidHoles;
+		m_selectionDirty = true;
+	}
+}
+
+bool Cesium3DTileset::getOptimizeVertexCache() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getOptimizeVertexCache();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setOptimizeVertexCache(bool optimize)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setOptimizeVertexCache(optimize);
+	}
+}
+
+bool Cesium3DTileset::getShareTexturesAcrossTiles() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getShareTexturesAcrossTiles();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setShareTexturesAcrossTiles(bool share)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setShareTexturesAcrossTiles(share);
+	}
+}
+
+bool Cesium3DTileset::getShareStateSetsAcrossTiles() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getShareStateSetsAcrossTiles();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setShareStateSetsAcrossTiles(bool share)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setShareStateSetsAcrossTiles(share);
+	}
+}
+
+bool Cesium3DTileset::getFlattenHierarchy() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getFlattenHierarchy();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setFlattenHierarchy(bool flatten)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setFlattenHierarchy(flatten);
+	}
+}
+
+bool Cesium3DTileset::getMergeGeometries() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getMergeGeometries();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setMergeGeometries(bool merge)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setMergeGeometries(merge);
+	}
+}
+
+bool Cesium3DTileset::getBatchSiblingTiles() const
+{
+	return m_tileBatcher != nullptr;
+}
+
+void Cesium3DTileset::setBatchSiblingTiles(bool batch)
+{
+	if (batch && !m_tileBatcher) {
+		m_tileBatcher = std::make_shared<czmosg::TileBatcher>();
+	}
+	else if (!batch) {
+		m_tileBatcher.reset();
+	}
+	m_selectionDirty = true;
+}
+
+bool Cesium3DTileset::getTileBoundingVolumeCulling() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getTileBoundingVolumeCulling();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setTileBoundingVolumeCulling(bool cull)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setTileBoundingVolumeCulling(cull);
+	}
+}
+
+bool Cesium3DTileset::getReleaseModelData() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getReleaseModelData();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setReleaseModelData(bool release)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setReleaseModelData(release);
+	}
+}
+
+bool Cesium3DTileset::getDeferTileRelease() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getDeferRelease();
+	}
+	return false;
+}
+
+void Cesium3DTileset::setDeferTileRelease(bool defer)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setDeferRelease(defer);
+	}
+}
+
+unsigned int Cesium3DTileset::getTileReleaseBatchSize() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getReleaseBatchSize();
+	}
+	return 0;
+}
+
+void Cesium3DTileset::setTileReleaseBatchSize(unsigned int batchSize)
+{
+	if (m_prepareRenderResources) {
+		m_prepareRenderResources->setReleaseBatchSize(batchSize);
+	}
+}
+
+int64_t Cesium3DTileset::getMaximumCachedBytes() const
 {
-	static bool s_registered = false;
-	if (!s_registered) {
-		Cesium3DTilesContent::registerAllTileContentTypes();
-		CO_TRACE("Registered all Cesium 3D Tiles content types");
-		s_registered = true;
+	return m_maximumCachedBytes;
+}
+
+void Cesium3DTileset::setMaximumCachedBytes(int64_t bytes)
+{
+	m_maximumCachedBytes = std::max<int64_t>(0, bytes);
+	m_selectionDirty = true;
+}
+
+bool Cesium3DTileset::getAdaptiveMemoryBudget() const
+{
+	return m_adaptiveMemoryBudget;
+}
+
+void Cesium3DTileset::setAdaptiveMemoryBudget(bool adaptive)
+{
+	if (adaptive == m_adaptiveMemoryBudget) {
+		return;
+	}
+	if (adaptive) {
+		if (!m_cacheBudgetManager) {
+			m_fixedMaximumCachedBytes = m_maximumCachedBytes;
+		}
+		m_memoryGovernor->reset();
+	}
+	else {
+		if (!m_cacheBudgetManager) {
+			setMaximumCachedBytes(m_fixedMaximumCachedBytes);
+		}
+		if (m_prepareRenderResources) {
+			m_prepareRenderResources->setMaximumTextureSize(0);
+		}
 	}
+	m_adaptiveMemoryBudget = adaptive;
 }
 
-Cesium3DTileset::Cesium3DTileset(const std::string& url, float maximumScreenSpaceError)
-	: m_tileset(nullptr)
+double Cesium3DTileset::getMemoryShare() const
 {
-	ensureTileContentTypesRegistered();
-	initializeTileset(url, maximumScreenSpaceError);
-	setCullingActive(false);
+	return m_memoryGovernor->getMemoryShare();
 }
 
-Cesium3DTileset::Cesium3DTileset(unsigned int assetID, const std::string& server, const std::string& token, float maximumScreenSpaceError)
-	: m_tileset(nullptr)
+void Cesium3DTileset::setMemoryShare(double share)
 {
-	ensureTileContentTypesRegistered();
-	initializeTileset(assetID, server, token, maximumScreenSpaceError);
-	setCullingActive(false);
+	m_memoryGovernor->setMemoryShare(share);
 }
 
-Cesium3DTileset::~Cesium3DTileset()
+void Cesium3DTileset::setMemoryBudgetRange(int64_t minimum, int64_t maximum)
 {
-	if (m_tileset) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		delete tileset;
+	m_memoryGovernor->setCacheRange(minimum, maximum);
+}
+
+void Cesium3DTileset::setMemoryPressureCallback(std::function<void(const czmosg::MemoryPressureEvent&)> callback)
+{
+	m_memoryGovernor->setEventCallback(std::move(callback));
+}
+
+czmosg::MemoryPressureLevel Cesium3DTileset::getMemoryPressureLevel() const
+{
+	return m_memoryGovernor->getLevel();
+}
+
+std::shared_ptr<czmosg::CacheBudgetManager> Cesium3DTileset::getCacheBudgetManager() const
+{
+	return m_cacheBudgetManager;
+}
+
+void Cesium3DTileset::setCacheBudgetManager(std::shared_ptr<czmosg::CacheBudgetManager> manager)
+{
+	if (manager == m_cacheBudgetManager) {
+		return;
+	}
+	if (m_cacheBudgetManager) {
+		m_cacheBudgetManager->removeTileset(this);
+	}
+	else if (!m_adaptiveMemoryBudget) {
+		m_fixedMaximumCachedBytes = m_maximumCachedBytes;
+	}
+
+	m_cacheBudgetManager = std::move(manager);
+	if (m_cacheBudgetManager) {
+		m_cacheBudgetManager->addTileset(this, [this](int64_t budget, bool updated) {
+			applySharedCacheBudget(budget, updated);
+		});
+	}
+	else if (!m_adaptiveMemoryBudget) {
+		setMaximumCachedBytes(m_fixedMaximumCachedBytes);
 	}
 }
 
+double Cesium3DTileset::getScreenContribution() const
+{
+	return m_screenContribution;
+}
 
-float Cesium3DTileset::getMaximumScreenSpaceError() const
+czmosg::NodeByteSize Cesium3DTileset::getNodeByteSize() const
 {
-	if (m_tileset) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		return tileset->getOptions().maximumScreenSpaceError;
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getNodeByteSize();
 	}
-	return 16.0f;
+	return czmosg::NodeByteSize();
 }
 
-void Cesium3DTileset::setMaximumScreenSpaceError(float error)
+czmosg::NodeByteSize Cesium3DTileset::getTileByteSize(const Cesium3DTilesSelection::Tile& tile) const
 {
-	if (m_tileset) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		tileset->getOptions().maximumScreenSpaceError = error;
+	return SimpleRenderResourcesPreparer::getTileByteSize(tile);
+}
+
+czmosg::VertexCacheStatistics Cesium3DTileset::getVertexCacheStatistics() const
+{
+	if (m_prepareRenderResources) {
+		return m_prepareRenderResources->getVertexCacheStatistics();
 	}
+	return czmosg::VertexCacheStatistics();
 }
 
-bool Cesium3DTileset::getForbidHoles() const
+int64_t Cesium3DTileset::getTotalDataBytes() const
 {
+	int64_t bytes = 0;
 	if (m_tileset) {
 		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		return tileset->getOptions().forbidHoles;
+		bytes += tileset->getTotalDataBytes();
 	}
-	return false;
+	bytes += getNodeBytes();
+	return bytes;
 }
 
-void Cesium3DTileset::setForbidHoles(bool forbidHoles)
+int64_t Cesium3DTileset::getNodeBytes() const
 {
-	if (m_tileset) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		tileset->getOptions().forbidHoles = forbidHoles;
+	int64_t bytes = 0;
+	if (m_prepareRenderResources) {
+		bytes += static_cast<int64_t>(m_prepareRenderResources->getNodeBytes());
 	}
+	// 批次复制了成员瓦片的几何体，成员仍然保留，批次的占用同样计入预算
+	if (m_tileBatcher) {
+		bytes += static_cast<int64_t>(m_tileBatcher->getBatchBytes());
+	}
+	return bytes;
 }
 
 bool Cesium3DTileset::isRootTileAvailable() const
@@ -149,10 +824,11 @@ void Cesium3DTileset::initializeTileset(const std::string& url, float maximumScr
 
 	// 创建 TilesetOptions - 使用中等设置测试异步模式
 	Cesium3DTilesSelection::TilesetOptions options;
-	options.maximumScreenSpaceError = 16.0;  // 中等值，应该触发瓦片加载
+	options.maximumScreenSpaceError = maximumScreenSpaceError;
 	options.maximumCachedBytes = 256 * 1024 * 1024; // 256MB
-	options.maximumSimultaneousTileLoads = 1;  // 限制并发加载为1
-	options.loadingDescendantLimit = 1;  // 限制后代加载为1
+	// 并发加载数和后代加载数按任务处理器的模式确定（同步模式下为 1），可通过 setAsynchronousLoading、
+	// setMaximumSimultaneousTileLoads 等接口调整或开启自动调整
+	applyLoadLimits(options, m_taskProcessor->isSynchronous());
 	options.enableFrustumCulling = true;  // 启用视锥体剔除
 	options.enableFogCulling = true;  // 启用雾剔除
 	options.enableOcclusionCulling = true;
@@ -163,6 +839,7 @@ void Cesium3DTileset::initializeTileset(const std::string& url, float maximumScr
 	CO_INFO("Loading Cesium 3D Tiles from URL: {}", url);
 	CO_INFO("maximumScreenSpaceError: {}", options.maximumScreenSpaceError);
 	m_tileset = new Cesium3DTilesSelection::Tileset(externals, url, options);
+	m_maximumCachedBytes = options.maximumCachedBytes;
 
 	if (isRootTileAvailable()) {
 		CO_INFO("Root tile is immediately available after tileset creation");
@@ -178,6 +855,7 @@ void Cesium3DTileset::initializeTileset(unsigned int assetID, const std::string&
 {
 	// 创建必要的 Cesium 组件
 	m_taskProcessor = std::make_shared<AsyncTaskProcessor>();
+	m_asyncSystem = std::make_shared<CesiumAsync::AsyncSystem>(m_taskProcessor);
 	m_assetAccessor = std::make_shared<SimpleAssetAccessor>();
 	m_prepareRenderResources = std::make_shared<SimpleRenderResourcesPreparer>();
 	m_creditSystem = std::make_shared<CesiumUtility::CreditSystem>();
@@ -196,43 +874,94 @@ void Cesium3DTileset::initializeTileset(unsigned int assetID, const std::string&
 	Cesium3DTilesSelection::TilesetOptions options;
 	options.maximumScreenSpaceError = maximumScreenSpaceError;
 	options.contentOptions.generateMissingNormalsSmooth = true;
+	applyLoadLimits(options, m_taskProcessor->isSynchronous());
 
 	// 创建 Tileset（使用 Asset ID）
 	CO_INFO("Loading Cesium 3D Tiles from Asset ID: {}", assetID);
 	CO_INFO("maximumScreenSpaceError: {}", options.maximumScreenSpaceError);
 	m_tileset = new Cesium3DTilesSelection::Tileset(externals, assetID, token, options, server);
+	m_maximumCachedBytes = options.maximumCachedBytes;
 }
 
 osg::BoundingSphere Cesium3DTileset::computeBound() const
 {
-	if (m_tileset) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+	if (!m_tileset) {
+		CO_ERROR("computeBound - No tileset available");
+		return osg::BoundingSphere();
+	}
+	Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
 
-		// 检查根瓦片是否已经可用
-		if (!tileset->getRootTileAvailableEvent().isReady()) {
-			CO_TRACE("computeBound - Root tile not yet available, tileset still loading");
-			return osg::BoundingSphere();
-		}
+	// 检查根瓦片是否已经可用
+	if (!tileset->getRootTileAvailableEvent().isReady()) {
+		CO_TRACE("computeBound - Root tile not yet available, tileset still loading");
+		return osg::Group::computeBound();
+	}
 
-		auto rootTile = tileset->getRootTile();
-		if (rootTile) {
-			auto bbox = Cesium3DTilesSelection::getOrientedBoundingBoxFromBoundingVolume(rootTile->getBoundingVolume());
-			auto& center = bbox.getCenter();
-			auto& lengths = bbox.getLengths();
-			float radius = std::max(lengths.x, std::max(lengths.y, lengths.z));
-			CO_TRACE("computeBound - Center: ({}, {}, {})", center.x, center.y, center.z);
-			CO_TRACE("computeBound - Lengths: ({}, {}, {})", lengths.x, lengths.y, lengths.z);
-			CO_TRACE("computeBound - Radius: {}", radius);
-			return osg::BoundingSphere(osg::Vec3(center.x, center.y, center.z), radius);
-		}
-		else {
-			CO_ERROR("computeBound - Root tile available event is ready but no root tile found");
+	const Cesium3DTilesSelection::Tile* rootTile = tileset->getRootTile();
+	if (!rootTile) {
+		CO_ERROR("computeBound - Root tile available event is ready but no root tile found");
+		return osg::Group::computeBound();
+	}
+
+	// 根瓦片包围体的外接球（按完整的包围体类型和旋转计算），再包含当前渲染的瓦片，
+	// 内容超出根包围体的瓦片集也不会被父节点错误剔除。不能只包含渲染的瓦片，否则视野外的瓦片集不再被裁剪遍历，无法重新选择
+	osg::BoundingSphered bound = getTileBoundingSphere(rootTile->getBoundingVolume());
+	const osg::BoundingSphere childrenBound = osg::Group::computeBound();
+	if (childrenBound.valid()) {
+		bound.expandBy(osg::BoundingSphered(osg::Vec3d(childrenBound.center()), childrenBound.radius()));
+	}
+
+	// osg::BoundingSphere 以 float 存储，地心坐标下中心的舍入误差可达半米，半径加上中心的舍入误差并留出半径本身的舍入余量
+	const osg::Vec3 center(bound.center());
+	const double rounding = (osg::Vec3d(center) - bound.center()).length();
+	const double radius = (bound.radius() + rounding) * (1.0 + 1e-6);
+	CO_TRACE("computeBound - Center: ({}, {}, {}), radius: {}", bound.center().x(), bound.center().y(), bound.center().z(), radius);
+	return osg::BoundingSphere(center, static_cast<float>(radius));
+}
+
+void Cesium3DTileset::addRenderedNode(osg::Node* node)
+{
+	if (m_childIndices.try_emplace(node, getNumChildren()).second) {
+		addChild(node);
+	}
+}
+
+void Cesium3DTileset::removeRenderedNode(osg::Node* node)
+{
+	auto itr = m_childIndices.find(node);
+	if (itr == m_childIndices.end()) {
+		return;
+	}
+
+	// 用最后一个子节点填补空位，避免 removeChild 查找和移动后续子节点
+	const unsigned int index = itr->second;
+	const unsigned int last = getNumChildren() - 1;
+	m_childIndices.erase(itr);
+	if (index != last) {
+		osg::Node* lastNode = getChild(last);
+		setChild(index, lastNode);
+		m_childIndices[lastNode] = index;
+	}
+	removeChildren(last, 1);
+}
+
+void Cesium3DTileset::setRenderedNodes(const std::vector<osg::Node*>& nodes)
+{
+	std::unordered_set<osg::Node*> nodeSet(nodes.begin(), nodes.end());
+
+	std::vector<osg::ref_ptr<osg::Node>> removedNodes;
+	for (const auto& [node, index] : m_childIndices) {
+		if (!nodeSet.count(node)) {
+			removedNodes.push_back(node);
 		}
 	}
-	else {
-		CO_ERROR("computeBound - No tileset available");
+	for (const osg::ref_ptr<osg::Node>& node : removedNodes) {
+		removeRenderedNode(node.get());
+	}
+
+	for (osg::Node* node : nodes) {
+		addRenderedNode(node);
 	}
-	return osg::BoundingSphere();
 }
 
 void Cesium3DTileset::traverse(osg::NodeVisitor& nv)
@@ -259,107 +988,476 @@ void Cesium3DTileset::traverse(osg::NodeVisitor& nv)
 	//	}
 	//}
 
-	static int frameCount = 0;
+	const unsigned int frameNumber = nv.getFrameStamp() ? nv.getFrameStamp()->getFrameNumber() : 0;
 
-	if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR) {
-		Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
-		//// 检查根瓦片状态
-		//auto rootTile = tileset->getRootTile();
-		//if (rootTile) {
-		//	auto tileState = rootTile->getState();
-		//	if (tileState != Cesium3DTilesSelection::TileLoadState::Done &&
-		//		tileState != Cesium3DTilesSelection::TileLoadState::ContentLoaded
-		//		) {
-		//		CO_CRITICAL("Tileset root tile load failed, will not retry. Please check your URL or network.");
-		//		return;
-		//	}
-		//	CO_DEBUG("Root tile not ready for rendering, state: {}", static_cast<int>(tileState));
-		//}
-		//else {
-		//	CO_DEBUG("Root tile not yet available for state check");
-		//}
-
-		//
-		frameCount++;
-		CO_TRACE("Cesium3DTileset::traverse called (frame {})", frameCount);
-
-		const osgUtil::CullVisitor* cv = nv.asCullVisitor();
-		if (!cv) {
-			osg::Group::traverse(nv);
-			return;
+	if (nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR) {
+		// 根瓦片加载完成前包围球只包含子节点，可用后按根瓦片的包围体重新计算
+		if (!m_rootBoundAvailable && isRootTileAvailable()) {
+			m_rootBoundAvailable = true;
+			dirtyBound();
+		}
+
+		// 瓦片选择和场景图修改在更新遍历中进行，使用最近裁剪时记录的所有相机，一次 updateView 完成选择
+		std::vector<CameraState> cameraStates;
+		{
+			std::lock_guard<std::mutex> lock(m_cameraMutex);
+			for (auto itr = m_cameraStates.begin(); itr != m_cameraStates.end();) {
+				// 相机已析构，或长时间没有裁剪的视图（已移除或停用）不再参与选择
+				if (!itr->camera.valid() || itr->frameNumber + VIEW_TIMEOUT_FRAMES < frameNumber) {
+					m_cameraPredictor->removeView(itr->viewId);
+					itr = m_cameraStates.erase(itr);
+					continue;
+				}
+				cameraStates.push_back(*itr);
+				++itr;
+			}
+		}
+
+		// 相机运动按仿真时间外推（回放相机路径时与实际帧耗时无关），帧时间按真实时间统计
+		const double simulationTime = nv.getFrameStamp() ? nv.getFrameStamp()->getSimulationTime() : 0.0;
+		const double referenceTime = nv.getFrameStamp() ? nv.getFrameStamp()->getReferenceTime() : 0.0;
+		if (!cameraStates.empty()) {
+			updateTileSelection(cameraStates, predictCameraStates(cameraStates, simulationTime));
+		}
+
+		// 按上一帧的帧时间调整 SSE，新值在下一次选择时生效
+		const double frameTime = m_lastReferenceTime > 0.0 ? referenceTime - m_lastReferenceTime : 0.0;
+		m_lastReferenceTime = referenceTime;
+		if (m_adaptiveScreenSpaceError) {
+			updateScreenSpaceError(frameTime);
+		}
+		// 同步模式下加载在调用线程中执行，提高并发数没有收益，不做调整
+		if (m_autoTuneLoadConcurrency && getAsynchronousLoading()) {
+			updateLoadConcurrency(referenceTime);
+		}
+		if (m_adaptiveMemoryBudget) {
+			updateMemoryBudget(referenceTime);
+		}
+		if (m_cacheBudgetManager) {
+			// 没有相机裁剪本节点时（隐藏或移出视野）不再有屏幕贡献
+			m_cacheBudgetManager->update(this, frameNumber, cameraStates.empty() ? 0.0 : m_screenContribution, getTotalDataBytes());
 		}
+	}
+	else if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR) {
+		// 裁剪遍历只记录相机参数并读取更新遍历发布的渲染列表
+		osgUtil::CullVisitor* cv = nv.asCullVisitor();
+		if (cv) {
+			// 参考osgEarth实现：从 osg::NodeVisitor 实例动态计算相机参数
+			osg::Camera* camera = cv->getCurrentCamera();
+			CameraState cameraState;
+			cameraState.frameNumber = frameNumber;
+			osg::Vec3d osgCenter;
+			cv->getModelViewMatrix()->getLookAt(cameraState.eye, osgCenter, cameraState.up);
+			cameraState.direction = osgCenter - cameraState.eye;
+			cameraState.direction.normalize();
+			cameraState.viewportWidth = cv->getViewport()->width();
+			cameraState.viewportHeight = cv->getViewport()->height();
+
+			// 直接使用投影矩阵，正交投影和非对称视锥体（偏轴投影、拼接屏等）不能用视场角表示
+			cameraState.projectionMatrix = *cv->getProjectionMatrix();
+
+			std::shared_ptr<const RenderLists> renderLists;
+			{
+				std::lock_guard<std::mutex> lock(m_cameraMutex);
+
+				// 同一相机在一帧内被裁剪多次（SceneView 立体渲染的左右眼）时按裁剪次序区分视图
+				unsigned int eyeIndex = 0;
+				if (nv.getFrameStamp()) {
+					for (const CameraState& state : m_cameraStates) {
+						if (state.camera.get() == camera && state.frameNumber == frameNumber) {
+							++eyeIndex;
+						}
+					}
+				}
+
+				auto itr = std::find_if(m_cameraStates.begin(), m_cameraStates.end(), [&](const CameraState& state) {
+					return state.camera.get() == camera && state.eyeIndex == eyeIndex;
+				});
+				if (itr == m_cameraStates.end()) {
+					itr = m_cameraStates.emplace(m_cameraStates.end());
+					itr->camera = camera;
+					itr->eyeIndex = eyeIndex;
+					itr->viewId = ++m_nextViewId;
+				}
+				cameraState.camera = itr->camera;
+				cameraState.eyeIndex = itr->eyeIndex;
+				cameraState.viewId = itr->viewId;
+				*itr = cameraState;
+				renderLists = m_renderLists;
+			}
+
+			// 多个视图时每个视图只遍历自己可见的瓦片；尚未参与选择的视图遍历全部子节点
+			if (renderLists) {
+				auto itr = renderLists->find(cameraState.viewId);
+				if (itr != renderLists->end()) {
+					for (const osg::ref_ptr<osg::Node>& node : itr->second) {
+						node->accept(nv);
+					}
+					return;
+				}
+			}
+		}
+	}
+
+	osg::Group::traverse(nv);
+}
+
+void Cesium3DTileset::updateScreenSpaceError(double frameTime)
+{
+	czmosg::ScreenSpaceErrorController::Sample sample;
+	sample.frameTime = frameTime;
+	sample.visibleTriangles = m_visibleTriangles;
+	sample.workerThreadLoadQueueLength = m_workerThreadLoadQueueLength;
+	sample.mainThreadLoadQueueLength = m_mainThreadLoadQueueLength;
+
+	const float currentError = getMaximumScreenSpaceError();
+	const float error = m_sseController->update(currentError, sample);
+	if (error != currentError) {
+		setMaximumScreenSpaceError(error);
+	}
+}
+
+void Cesium3DTileset::updateLoadConcurrency(double time)
+{
+	const SimpleAssetAccessor::Statistics requestStatistics = m_assetAccessor->getStatistics();
+	const AsyncTaskProcessor::Statistics taskStatistics = m_taskProcessor->getStatistics();
+
+	czmosg::LoadConcurrencyTuner::Sample sample;
+	sample.time = time;
+	sample.requestsCompleted = requestStatistics.requestsCompleted;
+	sample.requestTime = requestStatistics.requestTime;
+	sample.queuedLoads = m_workerThreadLoadQueueLength + m_mainThreadLoadQueueLength;
+	sample.queuedTasks = taskStatistics.tasksQueued;
+
+	const uint32_t currentLoads = getMaximumSimultaneousTileLoads();
+	const uint32_t loads = m_loadConcurrencyTuner->update(currentLoads, sample);
+	if (loads != currentLoads) {
+		setMaximumSimultaneousTileLoads(loads);
+	}
+}
+
+void Cesium3DTileset::updateMemoryBudget(double time)
+{
+	// 共享预算时调节器按所有瓦片集的占用计算，结果作为共享预算的总量
+	const int64_t tileBytes = m_cacheBudgetManager ? m_cacheBudgetManager->getUsedBytes() : getTotalDataBytes();
+	if (!m_memoryGovernor->update(time, tileBytes)) {
+		return;
+	}
+
+	// 新预算在下一次选择时交给 cesium-native 淘汰；纹理上限只影响之后加载的瓦片
+	const int64_t cacheBytes = m_memoryGovernor->getCacheBytes();
+	if (m_cacheBudgetManager) {
+		m_cacheBudgetManager->setTotalBytes(cacheBytes);
+	}
+	else if (cacheBytes != m_maximumCachedBytes) {
+		CO_DEBUG("Memory governor: cache budget {} -> {} bytes", m_maximumCachedBytes, cacheBytes);
+		setMaximumCachedBytes(cacheBytes);
+	}
+	m_prepareRenderResources->setMaximumTextureSize(m_memoryGovernor->getMaximumTextureSize());
+}
+
+void Cesium3DTileset::applySharedCacheBudget(int64_t budget, bool updated)
+{
+	if (budget != m_maximumCachedBytes) {
+		setMaximumCachedBytes(budget);
+	}
+	if (!updated && getTotalDataBytes() > m_maximumCachedBytes) {
+		trimCache();
+	}
+}
+
+void Cesium3DTileset::trimCache()
+{
+	if (!m_tileset) {
+		return;
+	}
+	Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+
+	const int64_t nodeBytes = getNodeBytes();
+	tileset->getOptions().maximumCachedBytes = std::max<int64_t>(0, m_maximumCachedBytes - nodeBytes);
+
+	// loadTiles 在处理加载队列后按 maximumCachedBytes 卸载最久未使用的瓦片
+	tileset->loadTiles();
+	m_prepareRenderResources->advanceFrame();
+	CO_DEBUG("Trimmed tile cache to {} bytes ({} bytes in use)", m_maximumCachedBytes, getTotalDataBytes());
+}
+
+bool Cesium3DTileset::CameraState::isSameView(const CameraState& other) const
+{
+	// 位置按到原点距离的相对误差比较（地心坐标下约为毫米级），方向按单位向量的差比较
+	const double positionTolerance = 1e-9 * std::max(1.0, eye.length());
+	const double directionTolerance = 1e-6;
+	return viewId == other.viewId &&
+		(eye - other.eye).length() <= positionTolerance &&
+		(direction - other.direction).length() <= directionTolerance &&
+		(up - other.up).length() <= directionTolerance &&
+		viewportWidth == other.viewportWidth &&
+		viewportHeight == other.viewportHeight &&
+		isSameProjection(projectionMatrix, other.projectionMatrix);
+}
+
+osg::Matrixd Cesium3DTileset::CameraState::getViewMatrix() const
+{
+	return osg::Matrixd::lookAt(eye, eye + direction, up);
+}
+
+bool Cesium3DTileset::isSelectionIdle(const std::vector<CameraState>& cameraStates) const
+{
+	if (m_selectionDirty || m_loadsPending || cameraStates.size() != m_lastCameraStates.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < cameraStates.size(); ++i) {
+		if (!cameraStates[i].isSameView(m_lastCameraStates[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::vector<Cesium3DTileset::CameraState> Cesium3DTileset::predictCameraStates(const std::vector<CameraState>& cameraStates, double time)
+{
+	std::vector<CameraState> predictedStates;
+	for (const CameraState& cameraState : cameraStates) {
+		m_cameraPredictor->addSample(cameraState.viewId, time, { cameraState.eye, cameraState.direction, cameraState.up });
+		if (!m_predictivePrefetch) {
+			continue;
+		}
+
+		// 沿外推轨迹取若干个预测视图，视口缩小使其选择较粗的层级，只预取不渲染
+		for (unsigned int step = 1; step <= PREFETCH_STEPS; ++step) {
+			czmosg::CameraPredictor::Pose pose;
+			if (!m_cameraPredictor->predict(cameraState.viewId, m_prefetchLookahead * step / PREFETCH_STEPS, pose)) {
+				break;
+			}
+			CameraState predictedState = cameraState;
+			predictedState.eye = pose.eye;
+			predictedState.direction = pose.direction;
+			predictedState.up = pose.up;
+			predictedState.viewportWidth *= PREFETCH_VIEWPORT_SCALE;
+			predictedState.viewportHeight *= PREFETCH_VIEWPORT_SCALE;
+			predictedStates.push_back(predictedState);
+		}
+	}
+	return predictedStates;
+}
 
-		// 参考osgEarth实现：从 osg::NodeVisitor 实例动态计算相机参数
-		osg::Vec3d osgEye, osgCenter, osgUp;
-		cv->getModelViewMatrix()->getLookAt(osgEye, osgCenter, osgUp);
-		osg::Vec3d osgDir = osgCenter - osgEye;
-		osgDir.normalize();
+void Cesium3DTileset::updateTileSelection(const std::vector<CameraState>& cameraStates, const std::vector<CameraState>& predictedStates)
+{
+	Cesium3DTilesSelection::Tileset* tileset = static_cast<Cesium3DTilesSelection::Tileset*>(m_tileset);
+
+	++m_frameCount;
+	CO_TRACE("Cesium3DTileset::updateTileSelection called (frame {}, {} views)", m_frameCount, cameraStates.size());
+
+	// 相机未变化、没有待加载的瓦片且选项未修改时，上一次的选择结果仍然有效，跳过 updateView 和 loadTiles
+	if (isSelectionIdle(cameraStates)) {
+		m_prepareRenderResources->advanceFrame();
+		if (m_tileBatcher) {
+			// 批处理需要逐帧累计稳定帧数并安装后台构建完成的批次
+			std::vector<osg::Node*> nodesToRender;
+			m_tileBatcher->update(m_siblingGroups, nodesToRender);
+			setRenderedNodes(nodesToRender);
+		}
+		return;
+	}
+	m_lastCameraStates = cameraStates;
+	m_selectionDirty = false;
 
-		glm::dvec3 position(osgEye.x(), osgEye.y(), osgEye.z());
-		glm::dvec3 direction(osgDir.x(), osgDir.y(), osgDir.z());
-		glm::dvec3 up(osgUp.x(), osgUp.y(), osgUp.z());
-		glm::dvec2 viewportSize(cv->getViewport()->width(), cv->getViewport()->height());
+	// 预测视图排在真实相机之后，与真实视图一起在一次 updateView 中参与选择和加载
+	std::vector<CameraState> viewCameraStates = cameraStates;
+	viewCameraStates.insert(viewCameraStates.end(), predictedStates.begin(), predictedStates.end());
 
-		double vfov, ar, znear, zfar;
-		cv->getProjectionMatrix()->getPerspective(vfov, ar, znear, zfar);
-		vfov = osg::DegreesToRadians(vfov);
-		double hfov = 2 * atan(tan(vfov / 2) * (ar));
+	std::vector<Cesium3DTilesSelection::ViewState> viewStateList;
+	viewStateList.reserve(viewCameraStates.size());
+	for (const CameraState& cameraState : viewCameraStates) {
+		glm::dvec2 viewportSize(cameraState.viewportWidth, cameraState.viewportHeight);
 
 		// 调试输出相机参数
-		CO_TRACE("Camera position: ({}, {}, {})", position.x, position.y, position.z);
-		CO_TRACE("Camera direction: ({}, {}, {})", direction.x, direction.y, direction.z);
+		CO_TRACE("Camera position: ({}, {}, {})", cameraState.eye.x(), cameraState.eye.y(), cameraState.eye.z());
+		CO_TRACE("Camera direction: ({}, {}, {})", cameraState.direction.x(), cameraState.direction.y(), cameraState.direction.z());
 		CO_TRACE("Viewport size: ({}, {})", viewportSize.x, viewportSize.y);
-		CO_TRACE("FOV: hfov={}, vfov={}", glm::degrees(hfov), glm::degrees(vfov));
-
-		Cesium3DTilesSelection::ViewState viewState = Cesium3DTilesSelection::ViewState::create(
-			position, direction, up, viewportSize, hfov, vfov
-		);
-		std::vector<Cesium3DTilesSelection::ViewState> viewStateList = { viewState };
-		auto updateResult = tileset->updateView(viewStateList);
-
-		// 处理异步任务 - 在同步模式下这很重要
-		tileset->loadTiles();
-
-		CO_TRACE("Tiles to render this frame: {}", updateResult.tilesToRenderThisFrame.size());
-		CO_TRACE("Worker thread load queue: {}", updateResult.workerThreadTileLoadQueueLength);
-		CO_TRACE("Main thread load queue: {}", updateResult.mainThreadTileLoadQueueLength);
-
-		// 清除之前的子节点
-		removeChildren(0, getNumChildren());
-
-		// 添加要渲染的瓦片
-		for (const auto& tile : updateResult.tilesToRenderThisFrame) {
-			if (tile->getContent().isRenderContent()) {
-				MainThreadResult* result = reinterpret_cast<MainThreadResult*>(tile->getContent().getRenderContent()->getRenderResources());
-				if (result && result->node.valid()) {
-					CO_TRACE("Adding tile to scene graph");
-					addChild(result->node.get());
+
+		// 由观察矩阵和投影矩阵构造 ViewState：视锥体平面从裁剪矩阵中提取，正交投影按视口像素对应的世界尺寸计算屏幕空间误差
+		// OSG 矩阵的内存布局与 glm 的列主序 OpenGL 矩阵相同，可直接转换
+		viewStateList.emplace_back(
+			czmosg::osg2glm(cameraState.getViewMatrix()),
+			czmosg::osg2glm(cameraState.projectionMatrix),
+			viewportSize);
+	}
+
+	// cesium-native 只按 glTF 数据估算缓存大小，预算中扣除 OSG 资源的实际占用后再交给它执行淘汰
+	int64_t nodeBytes = getNodeBytes();
+	int64_t cesiumBudget = std::max<int64_t>(0, m_maximumCachedBytes - nodeBytes);
+	if (cesiumBudget == 0 && tileset->getOptions().maximumCachedBytes != 0) {
+		CO_DEBUG("OSG resources ({} bytes) exceed the cache budget ({} bytes)", nodeBytes, m_maximumCachedBytes);
+	}
+	tileset->getOptions().maximumCachedBytes = cesiumBudget;
+
+	auto updateResult = tileset->updateView(viewStateList);
+
+	// 处理异步任务 - 在同步模式下这很重要
+	tileset->loadTiles();
+
+	// 推进延迟释放队列，本帧之前被淘汰的瓦片资源分批在后台析构
+	m_prepareRenderResources->advanceFrame();
+
+	m_workerThreadLoadQueueLength = updateResult.workerThreadTileLoadQueueLength;
+	m_mainThreadLoadQueueLength = updateResult.mainThreadTileLoadQueueLength;
+
+	// 只渲染真实相机可见的瓦片；只被预测视图选中的瓦片已经开始加载，但不加入场景图
+	std::vector<std::pair<const Cesium3DTilesSelection::Tile*, osg::Node*>> renderTiles;
+	renderTiles.reserve(updateResult.tilesToRenderThisFrame.size());
+	// 本帧只被预测视图选中的瓦片：仍在 cesium-native 的渲染集合中（不会出现在 tilesFadingOut 里），需单独从子节点中移除
+	std::vector<const Cesium3DTilesSelection::Tile*> predictedOnlyTiles;
+	m_visibleTriangles = 0;
+	for (const auto& tile : updateResult.tilesToRenderThisFrame) {
+		const MainThreadResult* result = getTileResult(*tile);
+		if (!result || !result->node.valid()) {
+			continue;
+		}
+		if (!predictedStates.empty()) {
+			bool visible = false;
+			for (size_t i = 0; i < cameraStates.size() && !visible; ++i) {
+				visible = viewStateList[i].isBoundingVolumeVisible(tile->getBoundingVolume());
+			}
+			if (!visible) {
+				m_prefetchedTiles.insert(tile.get());
+				predictedOnlyTiles.push_back(tile.get());
+				continue;
+			}
+		}
+		renderTiles.emplace_back(tile.get(), result->node.get());
+		m_visibleTriangles += result->triangles;
+	}
+	m_prefetchStatistics.predictedViews += predictedStates.size();
+
+	// 可见瓦片覆盖的屏幕比例，作为共享缓存预算的分配依据
+	m_screenContribution = 0.0;
+	if (m_cacheBudgetManager) {
+		for (size_t i = 0; i < cameraStates.size(); ++i) {
+			double coverage = 0.0;
+			for (const auto& [tile, node] : renderTiles) {
+				if (cameraStates.size() == 1 || viewStateList[i].isBoundingVolumeVisible(tile->getBoundingVolume())) {
+					coverage += computeScreenCoverage(getTileBoundingSphere(tile->getBoundingVolume()),
+						cameraStates[i].eye, cameraStates[i].projectionMatrix);
 				}
 			}
-			//else {
-			//	const auto& content = tile->getContent();
-			//	std::cout << "Tile content - isRenderContent: " << content.isRenderContent()
-			//		<< ", isEmptyContent: " << content.isEmptyContent()
-			//		<< ", isExternalContent: " << content.isExternalContent() << std::endl;
-
-			//	// 如果是空内容，检查子瓦片
-			//	if (content.isEmptyContent()) {
-			//		std::cout << "Empty tile, checking children..." << std::endl;
-			//		// 强制加载子瓦片
-			//		auto children = tile->getChildren();
-			//		std::cout << "Number of children: " << children.size() << std::endl;
-			//		for (const auto& child : children) {
-			//			std::cout << "Child tile state: " << static_cast<int>(child.getState()) << std::endl;
-			//		}
-			//	}
-			//}
+			m_screenContribution += std::min(1.0, coverage);
 		}
 	}
-	else if (nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR) {
-		// 在UPDATE_VISITOR中不做瓦片更新，只调用基类
-		osg::Group::traverse(nv);
-		return;
+
+	m_loadsPending = updateResult.workerThreadTileLoadQueueLength > 0 ||
+		updateResult.mainThreadTileLoadQueueLength > 0 ||
+		tileset->computeLoadProgress() < 100.0f;
+
+	CO_TRACE("Tiles to render this frame: {}", updateResult.tilesToRenderThisFrame.size());
+	CO_TRACE("Worker thread load queue: {}", updateResult.workerThreadTileLoadQueueLength);
+	CO_TRACE("Main thread load queue: {}", updateResult.mainThreadTileLoadQueueLength);
+
+	// 开启跨瓦片批处理时，按父瓦片收集兄弟瓦片，稳定的兄弟集合由批次节点代替
+	m_siblingGroups.clear();
+	std::unordered_map<const void*, size_t> siblingGroupIndices;
+
+	if (m_tileBatcher) {
+		m_renderedTiles.clear();
+
+		for (const auto& [tile, node] : renderTiles) {
+			auto [itr, inserted] = siblingGroupIndices.emplace(tile->getParent(), m_siblingGroups.size());
+			if (inserted) {
+				m_siblingGroups.push_back({ tile->getParent(), {} });
+			}
+			m_siblingGroups[itr->second].nodes.push_back(node);
+		}
+
+		std::vector<osg::Node*> nodesToRender;
+		m_tileBatcher->update(m_siblingGroups, nodesToRender);
+		setRenderedNodes(nodesToRender);
+		CO_TRACE("Rendering {} nodes for {} tiles", nodesToRender.size(), renderTiles.size());
 	}
+	else {
+		// 子节点在帧间保留，只移除淡出的瓦片、添加新渲染的瓦片，场景图的修改量与可见集合的变化量成正比
+		size_t removed = 0;
+		for (const auto& tile : updateResult.tilesFadingOut) {
+			auto itr = m_renderedTiles.find(tile.get());
+			if (itr != m_renderedTiles.end()) {
+				removeRenderedNode(itr->second.get());
+				m_renderedTiles.erase(itr);
+				++removed;
+			}
+		}
 
-	osg::Group::traverse(nv);
+		// 上一帧渲染、本帧只被预测视图选中的瓦片同样移除，渲染记录与本帧的渲染集合保持一致
+		for (const Cesium3DTilesSelection::Tile* tile : predictedOnlyTiles) {
+			auto itr = m_renderedTiles.find(tile);
+			if (itr != m_renderedTiles.end()) {
+				removeRenderedNode(itr->second.get());
+				m_renderedTiles.erase(itr);
+				++removed;
+			}
+		}
+
+		size_t added = 0;
+		for (const auto& [tile, node] : renderTiles) {
+			auto [itr, inserted] = m_renderedTiles.try_emplace(tile, node);
+			if (inserted) {
+				addRenderedNode(node);
+				++added;
+
+				// 进入渲染集合时已经由预测视图加载好的瓦片计为一次预取命中
+				++m_prefetchStatistics.tilesEntered;
+				if (m_prefetchedTiles.erase(tile) > 0) {
+					++m_prefetchStatistics.prefetchHits;
+				}
+			}
+			else if (itr->second.get() != node) {
+				// 瓦片内容被重新加载，替换为新的节点
+				removeRenderedNode(itr->second.get());
+				itr->second = node;
+				addRenderedNode(node);
+				++added;
+			}
+		}
+
+		// 有瓦片未经淡出就停止渲染（或子节点与记录不一致）时，按本帧的渲染集合完整对齐一次
+		if (m_renderedTiles.size() != renderTiles.size() || m_childIndices.size() != m_renderedTiles.size()) {
+			CO_DEBUG("Rendered tile set out of sync ({} tracked, {} rendered), reconciling",
+				m_renderedTiles.size(), renderTiles.size());
+
+			std::unordered_map<const Cesium3DTilesSelection::Tile*, osg::ref_ptr<osg::Node>> renderedTileMap;
+			std::vector<osg::Node*> nodesToRender;
+			for (const auto& [tile, node] : renderTiles) {
+				if (renderedTileMap.try_emplace(tile, node).second) {
+					nodesToRender.push_back(node);
+				}
+			}
+			setRenderedNodes(nodesToRender);
+			m_renderedTiles.swap(renderedTileMap);
+		}
+
+		CO_TRACE("Rendered tiles: {} added, {} removed, {} total", added, removed, m_renderedTiles.size());
+	}
+
+	// 预取的瓦片可能永远不会进入渲染集合（轨迹改变），集合过大时清空，避免无限增长
+	if (m_prefetchedTiles.size() > MAX_PREFETCHED_TILES) {
+		m_prefetchedTiles.clear();
+	}
+
+	// 多个相机时 tilesToRenderThisFrame 是所有视图的并集，按各视图的视锥体拆分出每个相机的渲染列表
+	std::shared_ptr<RenderLists> renderLists;
+	if (!m_tileBatcher && cameraStates.size() > 1) {
+		renderLists = std::make_shared<RenderLists>();
+		for (const CameraState& cameraState : cameraStates) {
+			(*renderLists)[cameraState.viewId].reserve(renderTiles.size());
+		}
+
+		for (const auto& [tile, node] : renderTiles) {
+			for (size_t i = 0; i < cameraStates.size(); ++i) {
+				if (viewStateList[i].isBoundingVolumeVisible(tile->getBoundingVolume())) {
+					(*renderLists)[cameraStates[i].viewId].push_back(node);
+				}
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_cameraMutex);
+	m_renderLists = std::move(renderLists);
 }
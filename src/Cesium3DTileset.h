@@ -1,13 +1,27 @@
 #pragma once
 
+#include "MemoryGovernor.h"
+#include "MemoryUsage.h"
+#include "MeshOptimizer.h"
+
 #include <osg/Group>
+#include <osg/Matrixd>
+#include <osg/Vec3d>
+#include <osg/observer_ptr>
 
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // 前向声明
 namespace Cesium3DTilesSelection {
     class Tileset;
+    class Tile;
 }
 
 namespace CesiumAsync {
@@ -19,12 +33,37 @@ namespace CesiumUtility {
     class CreditSystem;
 }
 
+namespace osg {
+    class Camera;
+}
+
+namespace czmosg {
+    class CacheBudgetManager;
+    class CameraPredictor;
+    class LoadConcurrencyTuner;
+    class ScreenSpaceErrorController;
+    class TileBatcher;
+    struct SiblingTileGroup;
+}
+
 class AsyncTaskProcessor;
 class SimpleAssetAccessor;
 class SimpleRenderResourcesPreparer;
 
 class Cesium3DTileset : public osg::Group {
 public:
+    // 预测预取的统计
+    struct PrefetchStatistics
+    {
+        // 进入渲染集合的瓦片数，其中进入前已由预测视图加载的瓦片数
+        uint64_t tilesEntered = 0;
+        uint64_t prefetchHits = 0;
+        // 参与选择的预测视图总数
+        uint64_t predictedViews = 0;
+
+        double hitRate() const { return tilesEntered > 0 ? double(prefetchHits) / double(tilesEntered) : 0.0; }
+    };
+
     // 构造函数：支持 URL 和 Asset ID 两种方式
     Cesium3DTileset(const std::string& url, float maximumScreenSpaceError = 16.0f);
     Cesium3DTileset(unsigned int assetID, const std::string& server = "", const std::string& token = "", float maximumScreenSpaceError = 16.0f);
@@ -35,17 +74,177 @@ public:
     // 重写 traverse 方法来处理瓦片集更新和渲染
     virtual void traverse(osg::NodeVisitor& nv) override;
     
-    // 重写 computeBound 方法
+    // 包围球：根瓦片包围体的外接球，并包含当前渲染的所有瓦片
     virtual osg::BoundingSphere computeBound() const override;
     
     // 设置和获取最大屏幕空间误差
     void setMaximumScreenSpaceError(float error);
     float getMaximumScreenSpaceError() const;
+
+    // 设置和获取是否根据帧时间自动调整最大屏幕空间误差（默认关闭）
+    void setAdaptiveScreenSpaceError(bool adaptive);
+    bool getAdaptiveScreenSpaceError() const;
+
+    // 设置自适应调整时屏幕空间误差的范围（默认 16 ~ 64）
+    void setScreenSpaceErrorRange(float minimum, float maximum);
+    float getMinimumAdaptiveScreenSpaceError() const;
+    float getMaximumAdaptiveScreenSpaceError() const;
+
+    // 设置和获取自适应调整的目标帧率（默认 30）
+    void setTargetFrameRate(double frameRate);
+    double getTargetFrameRate() const;
+
+    // 设置和获取可见三角形预算，超出时同样增大屏幕空间误差，0 表示不限制（默认）
+    void setTriangleBudget(uint64_t triangles);
+    uint64_t getTriangleBudget() const;
+
+    // 获取最近一次选择渲染的三角形数
+    uint64_t getVisibleTriangles() const;
+
+    // 获取最近一次选择后等待加载的瓦片数（工作线程和主线程队列之和）
+    uint32_t getLoadQueueLength() const;
+
+    // 设置和获取同时加载的瓦片数上限
+    void setMaximumSimultaneousTileLoads(uint32_t loads);
+    uint32_t getMaximumSimultaneousTileLoads() const;
+
+    // 设置和获取同时加载的隐式瓦片子树数上限
+    void setMaximumSimultaneousSubtreeLoads(uint32_t loads);
+    uint32_t getMaximumSimultaneousSubtreeLoads() const;
+
+    // 设置和获取细化时允许同时等待加载的后代瓦片数，超出时先渲染祖先瓦片
+    void setLoadingDescendantLimit(uint32_t limit);
+    uint32_t getLoadingDescendantLimit() const;
+
+    // 设置和获取是否预加载祖先瓦片和兄弟瓦片
+    void setPreloadAncestors(bool preload);
+    bool getPreloadAncestors() const;
+    void setPreloadSiblings(bool preload);
+    bool getPreloadSiblings() const;
+
+    // 设置和获取是否启用视锥体剔除和雾剔除
+    void setEnableFrustumCulling(bool enable);
+    bool getEnableFrustumCulling() const;
+    void setEnableFogCulling(bool enable);
+    bool getEnableFogCulling() const;
+
+    // 设置和获取异步模式下加载任务的工作线程数
+    void setLoadWorkerThreadCount(unsigned int count);
+    unsigned int getLoadWorkerThreadCount() const;
+
+    // 设置和获取是否在工作线程中异步执行加载任务（默认关闭，任务在调用线程中同步执行）
+    // 同步模式下同时加载的瓦片数和后代加载数为 1，切换模式时重置为该模式的默认值
+    void setAsynchronousLoading(bool asynchronous);
+    bool getAsynchronousLoading() const;
+
+    // 设置和获取是否沿相机运动轨迹外推预测视图，提前加载相机即将看到的瓦片（默认关闭）
+    void setPredictivePrefetch(bool prefetch);
+    bool getPredictivePrefetch() const;
+
+    // 设置和获取预测的时间跨度（秒，默认 1）
+    void setPrefetchLookahead(double seconds);
+    double getPrefetchLookahead() const;
+
+    // 获取和重置预测预取的统计
+    PrefetchStatistics getPrefetchStatistics() const;
+    void resetPrefetchStatistics();
+
+    // 设置和获取是否根据请求吞吐量和耗时自动调整同时加载的瓦片数（默认关闭，只在异步加载模式下生效）
+    void setAutoTuneLoadConcurrency(bool autoTune);
+    bool getAutoTuneLoadConcurrency() const;
+
+    // 设置自动调整时并发数的范围（默认 1 ~ 32）和可接受的平均请求耗时（秒，默认 2）
+    void setLoadConcurrencyRange(uint32_t minimum, uint32_t maximum);
+    void setMaximumLoadLatency(double latency);
+    double getMaximumLoadLatency() const;
     
     // 设置和获取是否禁止孔洞
     void setForbidHoles(bool forbidHoles);
     bool getForbidHoles() const;
+
+    // 设置和获取是否在加载线程中对瓦片执行顶点缓存优化（默认关闭）
+    void setOptimizeVertexCache(bool optimize);
+    bool getOptimizeVertexCache() const;
+
+    // 设置和获取是否按像素内容在瓦片之间共享纹理（默认关闭，模型内部始终去重）
+    void setShareTexturesAcrossTiles(bool share);
+    bool getShareTexturesAcrossTiles() const;
+
+    // 设置和获取是否在瓦片之间共享内容相同的 StateSet 和材质（默认关闭）
+    void setShareStateSetsAcrossTiles(bool share);
+    bool getShareStateSetsAcrossTiles() const;
+
+    // 设置和获取是否压平瓦片内的节点层级，每个瓦片只保留一个 Geode（默认关闭）
+    void setFlattenHierarchy(bool flatten);
+    bool getFlattenHierarchy() const;
+
+    // 设置和获取是否合并瓦片内材质和顶点布局相同的几何体（默认关闭，配合压平层级效果最好）
+    void setMergeGeometries(bool merge);
+    bool getMergeGeometries() const;
+
+    // 设置和获取是否把持续稳定可见的兄弟瓦片在后台合并为批次节点渲染（默认关闭）
+    void setBatchSiblingTiles(bool batch);
+    bool getBatchSiblingTiles() const;
     
+    // 设置和获取是否按 cesium-native 的瓦片包围体剔除瓦片节点（默认开启，对之后加载的瓦片生效）
+    // 开启时节点的包围球也由包围体给出，不再遍历几何体计算
+    void setTileBoundingVolumeCulling(bool cull);
+    bool getTileBoundingVolumeCulling() const;
+
+    // 设置和获取是否在瓦片转换为 OSG 资源后释放 glTF 模型数据（默认关闭，开启后高度采样等功能不可用）
+    void setReleaseModelData(bool release);
+    bool getReleaseModelData() const;
+
+    // 设置和获取是否延迟、分批在后台线程中析构被淘汰的瓦片资源（默认开启）
+    void setDeferTileRelease(bool defer);
+    bool getDeferTileRelease() const;
+
+    // 设置和获取每帧最多析构的瓦片资源数
+    void setTileReleaseBatchSize(unsigned int batchSize);
+    unsigned int getTileReleaseBatchSize() const;
+
+    // 设置和获取瓦片缓存的内存预算，按实际占用（cesium-native 持有的模型数据 + OSG 资源）计算
+    void setMaximumCachedBytes(int64_t bytes);
+    int64_t getMaximumCachedBytes() const;
+
+    // 设置和获取是否按系统内存和进程占用自动调整缓存预算和新瓦片的纹理尺寸上限（默认关闭）
+    // 开启后覆盖 setMaximumCachedBytes 设置的预算，关闭时恢复
+    void setAdaptiveMemoryBudget(bool adaptive);
+    bool getAdaptiveMemoryBudget() const;
+
+    // 设置和获取自动调整时进程可以使用的系统内存比例（默认 0.5）
+    void setMemoryShare(double share);
+    double getMemoryShare() const;
+
+    // 设置自动调整时缓存预算的范围（默认 32 MB 以上，maximum 为 0 表示不设上限）
+    void setMemoryBudgetRange(int64_t minimum, int64_t maximum);
+
+    // 设置降低内存占用（压力等级升高或缓存预算明显减小）时的回调，在更新遍历中调用
+    void setMemoryPressureCallback(std::function<void(const czmosg::MemoryPressureEvent&)> callback);
+
+    // 获取当前的内存压力等级
+    czmosg::MemoryPressureLevel getMemoryPressureLevel() const;
+
+    // 设置和获取共享缓存预算的管理器，多个瓦片集按屏幕贡献分配同一个预算（为空时使用自己的预算）
+    // 加入后覆盖 setMaximumCachedBytes 设置的预算，退出时恢复；与内存压力调节同时开启时由调节器设置共享预算的总量
+    void setCacheBudgetManager(std::shared_ptr<czmosg::CacheBudgetManager> manager);
+    std::shared_ptr<czmosg::CacheBudgetManager> getCacheBudgetManager() const;
+
+    // 获取最近一次选择时可见瓦片覆盖的屏幕比例（每个相机最多为 1，多个相机时求和；只在使用共享预算时计算）
+    double getScreenContribution() const;
+
+    // 获取瓦片集实际占用的内存字节数（cesium-native 持有的模型数据 + OSG 资源）
+    int64_t getTotalDataBytes() const;
+
+    // 获取所有已加载瓦片 OSG 资源占用的字节数（按类别）
+    czmosg::NodeByteSize getNodeByteSize() const;
+
+    // 获取单个瓦片 OSG 资源占用的字节数
+    czmosg::NodeByteSize getTileByteSize(const Cesium3DTilesSelection::Tile& tile) const;
+
+    // 获取顶点缓存优化的累计统计（所有已加载瓦片，含优化前后的 ACMR；未开启优化时为空）
+    czmosg::VertexCacheStatistics getVertexCacheStatistics() const;
+
     // 检查根瓦片是否可用
     bool isRootTileAvailable() const;
 
@@ -53,19 +252,132 @@ public:
     bool isLoaded() const;
     
 private:
+    // 裁剪遍历时记录的相机参数，供下一帧的更新遍历选择瓦片
+    struct CameraState
+    {
+        // 视图标识：相机（弱引用，相机析构后失效）+ 同一帧内该相机的第几次裁剪（SceneView 立体渲染的左右眼）
+        osg::observer_ptr<osg::Camera> camera;
+        unsigned int eyeIndex = 0;
+        // 视图首次出现时分配、不会复用的编号，用于渲染列表和相机运动预测
+        uint64_t viewId = 0;
+        unsigned int frameNumber = 0;
+        osg::Vec3d eye;
+        osg::Vec3d direction;
+        osg::Vec3d up;
+        double viewportWidth = 0.0;
+        double viewportHeight = 0.0;
+        // 投影矩阵（透视、正交或非对称视锥体），与观察矩阵一起构造 ViewState
+        osg::Matrixd projectionMatrix;
+
+        // 由位置和朝向构造的观察矩阵（预测视图只修改位置和朝向）
+        osg::Matrixd getViewMatrix() const;
+
+        // 在容差范围内是否为同一视图
+        bool isSameView(const CameraState& other) const;
+    };
+
+    // 每个视图（按视图编号）的渲染列表，由更新遍历整体发布，裁剪遍历只读
+    using RenderLists = std::unordered_map<uint64_t, std::vector<osg::ref_ptr<osg::Node>>>;
+
+    // 相机超过该帧数没有裁剪本节点时不再参与瓦片选择
+    static constexpr unsigned int VIEW_TIMEOUT_FRAMES = 10;
+
+    // 每个相机的预测视图数和预测视图的视口缩放
+    static constexpr unsigned int PREFETCH_STEPS = 2;
+    static constexpr double PREFETCH_VIEWPORT_SCALE = 0.5;
+    // 记录的已预取瓦片数上限
+    static constexpr size_t MAX_PREFETCHED_TILES = 4096;
+
 	// 初始化瓦片集的私有方法
     void initializeTileset(const std::string& url, float maximumScreenSpaceError);
     void initializeTileset(unsigned int assetID, const std::string& server, const std::string& token, float maximumScreenSpaceError);
 
+    // OSG 资源占用的字节数：已加载瓦片的节点 + 跨瓦片批次
+    int64_t getNodeBytes() const;
+
+    // 根据帧时间、可见三角形数和加载队列调整 SSE
+    void updateScreenSpaceError(double frameTime);
+
+    // 根据请求吞吐量、耗时和任务积压调整同时加载的瓦片数
+    void updateLoadConcurrency(double time);
+
+    // 按系统内存和进程占用调整缓存预算和纹理尺寸上限
+    void updateMemoryBudget(double time);
+
+    // 共享预算管理器分配的预算变化时调用；updated 为 false 表示本节点已不再被遍历，需要立即淘汰
+    void applySharedCacheBudget(int64_t budget, bool updated);
+
+    // 不执行选择，只按当前预算淘汰缓存中的瓦片（最近一次选择渲染的瓦片由 cesium-native 保留）
+    void trimCache();
+
+    // 记录相机运动并外推预测视图（未开启预测预取时返回空列表）
+    std::vector<CameraState> predictCameraStates(const std::vector<CameraState>& cameraStates, double time);
+
+    // 按所有相机（及预测视图）的参数执行一次瓦片选择和加载，并更新子节点和每个相机的渲染列表
+    void updateTileSelection(const std::vector<CameraState>& cameraStates, const std::vector<CameraState>& predictedStates);
+
+    // 上一次选择结果是否仍然有效（相机未变化、没有待加载的瓦片、选项未修改）
+    bool isSelectionIdle(const std::vector<CameraState>& cameraStates) const;
+
+    // 增量维护子节点：交换删除，不移动其余子节点
+    void addRenderedNode(osg::Node* node);
+    void removeRenderedNode(osg::Node* node);
+    // 把子节点集合调整为 nodes，只增删有变化的节点
+    void setRenderedNodes(const std::vector<osg::Node*>& nodes);
+
 private:
     void* m_tileset = nullptr; // 指向 Cesium3DTilesSelection::Tileset 的指针
     bool m_tilesetSuccess = false;
     bool m_tilesetFailed = false;
 	bool m_waitingLogged = false;
+	bool m_rootBoundAvailable = false;
+	int64_t m_maximumCachedBytes = 0;
+	int m_frameCount = 0;
+
+    // 多个相机的裁剪可能在不同线程中并行进行
+    std::mutex m_cameraMutex;
+    std::vector<CameraState> m_cameraStates;
+    uint64_t m_nextViewId = 0;
+    std::shared_ptr<const RenderLists> m_renderLists;
 
     std::shared_ptr<AsyncTaskProcessor> m_taskProcessor ;
     std::shared_ptr<CesiumAsync::AsyncSystem> m_asyncSystem;
     std::shared_ptr<SimpleAssetAccessor> m_assetAccessor;
     std::shared_ptr<SimpleRenderResourcesPreparer> m_prepareRenderResources;
     std::shared_ptr<CesiumUtility::CreditSystem> m_creditSystem;
+    std::shared_ptr<czmosg::TileBatcher> m_tileBatcher;
+    std::shared_ptr<czmosg::ScreenSpaceErrorController> m_sseController;
+    std::shared_ptr<czmosg::LoadConcurrencyTuner> m_loadConcurrencyTuner;
+    bool m_autoTuneLoadConcurrency = false;
+
+    // 内存压力调节和共享预算，开启前的缓存预算在两者都关闭时恢复
+    std::shared_ptr<czmosg::MemoryGovernor> m_memoryGovernor;
+    bool m_adaptiveMemoryBudget = false;
+    std::shared_ptr<czmosg::CacheBudgetManager> m_cacheBudgetManager;
+    double m_screenContribution = 0.0;
+    int64_t m_fixedMaximumCachedBytes = 0;
+
+    // 预测预取
+    std::shared_ptr<czmosg::CameraPredictor> m_cameraPredictor;
+    bool m_predictivePrefetch = false;
+    double m_prefetchLookahead = 1.0;
+    std::unordered_set<const Cesium3DTilesSelection::Tile*> m_prefetchedTiles;
+    PrefetchStatistics m_prefetchStatistics;
+
+    // 自适应 SSE 使用的测量值
+    bool m_adaptiveScreenSpaceError = false;
+    double m_lastReferenceTime = 0.0;
+    uint64_t m_visibleTriangles = 0;
+    uint32_t m_workerThreadLoadQueueLength = 0;
+    uint32_t m_mainThreadLoadQueueLength = 0;
+
+    // 上一帧渲染的瓦片及其节点，以及子节点在 Group 中的下标
+    std::unordered_map<const Cesium3DTilesSelection::Tile*, osg::ref_ptr<osg::Node>> m_renderedTiles;
+    std::unordered_map<osg::Node*, unsigned int> m_childIndices;
+
+    // 上一次执行选择时的相机和加载状态，用于跳过静止场景的重复选择
+    std::vector<CameraState> m_lastCameraStates;
+    std::vector<czmosg::SiblingTileGroup> m_siblingGroups;
+    bool m_loadsPending = true;
+    bool m_selectionDirty = true;
 };
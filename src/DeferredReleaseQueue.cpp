@@ -0,0 +1,189 @@
+#include "DeferredReleaseQueue.h"
+#include "Log.h"
+
+#include <osg/Drawable>
+#include <osg/Node>
+#include <osg/NodeVisitor>
+#include <osg/StateSet>
+
+#include <iterator>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 断开子图与外部共享对象的连接：共享的 StateSet 整体摘除，独占 StateSet 中共享的属性逐个移除
+		class DetachSharedStateVisitor : public osg::NodeVisitor
+		{
+		public:
+			DetachSharedStateVisitor()
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+			{
+			}
+
+			void apply(osg::Node& node) override
+			{
+				if (detach(node.getStateSet())) {
+					node.setStateSet(nullptr);
+				}
+				traverse(node);
+			}
+
+			void apply(osg::Drawable& drawable) override
+			{
+				if (detach(drawable.getStateSet())) {
+					drawable.setStateSet(nullptr);
+				}
+			}
+
+		private:
+			// StateSet 被其他对象引用时返回 true
+			static bool detach(osg::StateSet* stateSet)
+			{
+				if (!stateSet) {
+					return false;
+				}
+				if (stateSet->referenceCount() > 1) {
+					return true;
+				}
+
+				std::vector<osg::StateAttribute*> attributes;
+				for (const auto& [type, attribute] : stateSet->getAttributeList()) {
+					if (attribute.first->referenceCount() > 1) {
+						attributes.push_back(attribute.first.get());
+					}
+				}
+				for (osg::StateAttribute* attribute : attributes) {
+					stateSet->removeAttribute(attribute);
+				}
+
+				const osg::StateSet::TextureAttributeList& textureAttributes = stateSet->getTextureAttributeList();
+				for (unsigned int unit = 0; unit < textureAttributes.size(); ++unit) {
+					attributes.clear();
+					for (const auto& [type, attribute] : textureAttributes[unit]) {
+						if (attribute.first->referenceCount() > 1) {
+							attributes.push_back(attribute.first.get());
+						}
+					}
+					for (osg::StateAttribute* attribute : attributes) {
+						stateSet->removeTextureAttribute(unit, attribute);
+					}
+				}
+				return false;
+			}
+		};
+	}
+
+	DeferredReleaseQueue::DeferredReleaseQueue()
+	{
+		m_workerThread = std::thread(&DeferredReleaseQueue::workerThreadFunction, this);
+	}
+
+	DeferredReleaseQueue::~DeferredReleaseQueue()
+	{
+		m_shutdown = true;
+		m_condition.notify_all();
+
+		if (m_workerThread.joinable()) {
+			m_workerThread.join();
+		}
+
+		// 剩余条目随队列一起在当前线程中析构
+	}
+
+	void DeferredReleaseQueue::push(osg::ref_ptr<osg::Referenced> object)
+	{
+		if (!object.valid()) {
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_queue.push_back({ std::move(object), m_frame.load() });
+		++m_statistics.queued;
+	}
+
+	void DeferredReleaseQueue::advanceFrame()
+	{
+		const uint64_t frame = ++m_frame;
+
+		std::vector<osg::ref_ptr<osg::Referenced>> batch;
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			const unsigned int batchSize = m_batchSize;
+			while (!m_queue.empty() && batch.size() < batchSize && m_queue.front().frame + DELAY_FRAMES <= frame) {
+				batch.push_back(std::move(m_queue.front().object));
+				m_queue.pop_front();
+			}
+		}
+
+		if (batch.empty()) {
+			return;
+		}
+
+		// 仍被其它对象引用（例如仍在渲染的节点）的子图不会随队列析构，其状态也不能摘除，
+		// 只在主线程中释放队列持有的引用；只剩队列引用的子图交给后台线程析构
+		std::vector<osg::ref_ptr<osg::Referenced>> releasing;
+		size_t dropped = 0;
+		for (osg::ref_ptr<osg::Referenced>& object : batch) {
+			if (object->referenceCount() > 1) {
+				object = nullptr;
+				++dropped;
+				continue;
+			}
+
+			// 此时绘制线程已不再使用这些子图，可以在主线程中安全地修改共享对象的父节点列表
+			if (osg::Node* node = dynamic_cast<osg::Node*>(object.get())) {
+				DetachSharedStateVisitor visitor;
+				node->accept(visitor);
+			}
+			releasing.push_back(std::move(object));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_statistics.released += dropped;
+			m_releasing.insert(m_releasing.end(), std::make_move_iterator(releasing.begin()), std::make_move_iterator(releasing.end()));
+		}
+		if (!releasing.empty()) {
+			m_condition.notify_one();
+		}
+	}
+
+	DeferredReleaseQueue::Statistics DeferredReleaseQueue::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		Statistics statistics = m_statistics;
+		statistics.pending = m_queue.size() + m_releasing.size();
+		return statistics;
+	}
+
+	void DeferredReleaseQueue::workerThreadFunction()
+	{
+		while (!m_shutdown) {
+			std::vector<osg::ref_ptr<osg::Referenced>> batch;
+
+			{
+				std::unique_lock<std::mutex> lock(m_queueMutex);
+				m_condition.wait(lock, [this] { return m_shutdown || !m_releasing.empty(); });
+
+				if (m_shutdown) {
+					break;
+				}
+
+				batch.swap(m_releasing);
+			}
+
+			// 在锁外释放最后的引用，子图在此线程中析构
+			const size_t count = batch.size();
+			batch.clear();
+
+			{
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				m_statistics.released += count;
+			}
+			CO_TRACE("Released {} deferred tile resources", count);
+		}
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 延迟、分批释放瓦片资源的队列
+	 * 瓦片释放时只把 OSG 子图的引用放入队列，不在主线程（cesium-native 的缓存淘汰过程中）析构整棵子图。
+	 * 每帧调用 advanceFrame()：入队满 DELAY_FRAMES 帧的条目（确保绘制线程已不再使用）
+	 * 按每帧上限分批交给后台线程析构。OSG 析构纹理/缓冲对象时只是把 GL 对象放入孤儿列表，
+	 * 真正的 GL 删除仍由绘制线程在 flushDeletedGLObjects 中完成。
+	 * StateSet 和状态属性的父节点列表不是线程安全的，交给后台线程之前先在主线程中
+	 * 断开与其他瓦片共享的 StateSet、纹理和材质，后台线程只析构瓦片独占的对象。
+	 * 到期时仍被其它对象引用的条目不会被修改，只在主线程中释放队列持有的引用。
+	 */
+	class DeferredReleaseQueue
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t queued = 0;
+			uint64_t released = 0;
+			size_t pending = 0;
+		};
+
+		// 入队后至少等待多少帧才析构
+		static constexpr unsigned int DELAY_FRAMES = 2;
+
+		DeferredReleaseQueue();
+		~DeferredReleaseQueue();
+
+		// 设置每帧最多交给后台线程析构的条目数
+		void setBatchSize(unsigned int batchSize) { m_batchSize = batchSize; }
+		unsigned int getBatchSize() const { return m_batchSize; }
+
+		// 放入待释放的对象（任意线程）
+		void push(osg::ref_ptr<osg::Referenced> object);
+
+		// 每帧在主线程中调用一次，推进帧号并把到期的一批条目交给后台线程
+		void advanceFrame();
+
+		Statistics getStatistics() const;
+
+	private:
+		struct Entry
+		{
+			osg::ref_ptr<osg::Referenced> object;
+			uint64_t frame = 0;
+		};
+
+		void workerThreadFunction();
+
+		std::atomic<unsigned int> m_batchSize{ 64 };
+		std::atomic<uint64_t> m_frame{ 0 };
+
+		mutable std::mutex m_queueMutex;
+		std::deque<Entry> m_queue;
+		std::vector<osg::ref_ptr<osg::Referenced>> m_releasing;
+		Statistics m_statistics;
+
+		std::atomic<bool> m_shutdown{ false };
+		std::thread m_workerThread;
+		std::condition_variable m_condition;
+	};
+
+}	// namespace czmosg
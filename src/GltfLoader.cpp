@@ -158,6 +158,8 @@ namespace czmosg
 
         auto loadResult = future.wait();
 
+        // 共享状态不在工作线程中挂接
+        loadResult.sharedState.bind();
         return loadResult.node;
     }
 
@@ -220,7 +222,7 @@ namespace czmosg
                 //    return ReadGltfResult{transformNode, {}};
                 //}
                 
-                return ReadGltfResult{modelNode, {}};
+                return ReadGltfResult{modelNode, {}, nodeBuilder.takeSharedStateBindings()};
             });
     }
     
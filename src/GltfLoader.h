@@ -1,5 +1,7 @@
 #pragma once
 
+#include "NodeBuilder.h"
+
 #include <CesiumAsync/Future.h>
 #include <CesiumGltfReader/GltfReader.h>
 
@@ -21,6 +23,8 @@ namespace czmosg
         {
             osg::ref_ptr<osg::Node> node;
             std::vector<std::string> errors;
+            // 在调用 read() 的线程中挂接的共享状态
+            SharedStateBindings sharedState;
         };
 
         CesiumAsync::Future<ReadGltfResult> loadGltfNode(const std::string& uri) const;
@@ -0,0 +1,191 @@
+#include "Instancing.h"
+#include "Log.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/NodeVisitor>
+#include <osg/Program>
+#include <osg/Shader>
+#include <osg/Uniform>
+#include <osg/VertexAttribDivisor>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 兼容模式 GLSL：顶点按实例变换后沿用固定管线的矩阵、材质和光源
+		const char* INSTANCING_VERTEX_SHADER = R"(
+#version 120
+attribute vec4 instanceRow0;
+attribute vec4 instanceRow1;
+attribute vec4 instanceRow2;
+varying vec4 vertexColor;
+
+void main()
+{
+    vec4 position = vec4(dot(instanceRow0, gl_Vertex), dot(instanceRow1, gl_Vertex), dot(instanceRow2, gl_Vertex), 1.0);
+
+    // 法线直接使用实例矩阵的线性部分，非均匀缩放下会有少许偏差
+    vec3 normal = gl_Normal * mat3(instanceRow0.xyz, instanceRow1.xyz, instanceRow2.xyz);
+    normal = normalize(gl_NormalMatrix * normal);
+
+    vec4 eyePosition = gl_ModelViewMatrix * position;
+    vec3 lightDirection = gl_LightSource[0].position.w == 0.0
+        ? normalize(gl_LightSource[0].position.xyz)
+        : normalize(gl_LightSource[0].position.xyz - eyePosition.xyz);
+    float diffuse = max(dot(normal, lightDirection), 0.0);
+
+    vertexColor = gl_FrontLightModelProduct.sceneColor
+        + gl_FrontLightProduct[0].ambient
+        + gl_FrontLightProduct[0].diffuse * diffuse;
+    vertexColor.a = gl_FrontMaterial.diffuse.a;
+
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+    gl_Position = gl_ProjectionMatrix * eyePosition;
+}
+)";
+
+		const char* INSTANCING_FRAGMENT_SHADER = R"(
+#version 120
+uniform sampler2D baseColorTexture;
+uniform bool useTexture;
+varying vec4 vertexColor;
+
+void main()
+{
+    vec4 color = vertexColor;
+    if (useTexture) {
+        color *= texture2D(baseColorTexture, gl_TexCoord[0].st);
+    }
+    gl_FragColor = color;
+}
+)";
+
+		osg::ref_ptr<osg::StateSet> createInstancingStateSet(bool textured)
+		{
+			static osg::ref_ptr<osg::Program> s_program = [] {
+				osg::ref_ptr<osg::Program> program = new osg::Program;
+				program->setName("czmosg_instancing");
+				program->addShader(new osg::Shader(osg::Shader::VERTEX, INSTANCING_VERTEX_SHADER));
+				program->addShader(new osg::Shader(osg::Shader::FRAGMENT, INSTANCING_FRAGMENT_SHADER));
+				program->addBindAttribLocation("instanceRow0", INSTANCE_ROW0);
+				program->addBindAttribLocation("instanceRow1", INSTANCE_ROW1);
+				program->addBindAttribLocation("instanceRow2", INSTANCE_ROW2);
+				return program;
+			}();
+
+			osg::ref_ptr<osg::StateSet> stateSet = new osg::StateSet;
+			stateSet->setAttributeAndModes(s_program.get());
+			stateSet->setAttribute(new osg::VertexAttribDivisor(INSTANCE_ROW0, 1));
+			stateSet->setAttribute(new osg::VertexAttribDivisor(INSTANCE_ROW1, 1));
+			stateSet->setAttribute(new osg::VertexAttribDivisor(INSTANCE_ROW2, 1));
+			stateSet->addUniform(new osg::Uniform("baseColorTexture", 0));
+			stateSet->addUniform(new osg::Uniform("useTexture", textured));
+			return stateSet;
+		}
+
+		class InstancingVisitor : public osg::NodeVisitor
+		{
+		public:
+			InstancingVisitor(const std::vector<osg::Matrixd>& instances, const InstancingStateSets& stateSets)
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+				, m_instances(instances)
+				, m_stateSets(stateSets)
+			{
+			}
+
+			void apply(osg::Geode& geode) override
+			{
+				// 跨瓦片共享的纹理在主线程中才挂接，此时只有纹理模式，按模式判断是否带纹理
+				const osg::StateSet* stateSet = geode.getStateSet();
+				const bool textured = stateSet && (stateSet->getTextureMode(0, GL_TEXTURE_2D) & osg::StateAttribute::ON);
+
+				for (unsigned int i = 0; i < geode.getNumDrawables(); ++i) {
+					osg::Geometry* geometry = geode.getDrawable(i)->asGeometry();
+					if (geometry && !geometry->getStateSet() && !isInstancedGeometry(*geometry)) {
+						setupInstancedGeometry(*geometry, m_instances, textured ? m_stateSets.textured.get() : m_stateSets.untextured.get());
+						++count;
+					}
+				}
+			}
+
+			unsigned int count = 0;
+
+		private:
+			const std::vector<osg::Matrixd>& m_instances;
+			const InstancingStateSets& m_stateSets;
+		};
+	}
+
+	osg::StateSet* getInstancingStateSet(bool textured)
+	{
+		// StateSet 内容固定，所有瓦片共享，不会随瓦片释放
+		static osg::ref_ptr<osg::StateSet> s_textured = createInstancingStateSet(true);
+		static osg::ref_ptr<osg::StateSet> s_untextured = createInstancingStateSet(false);
+		return textured ? s_textured.get() : s_untextured.get();
+	}
+
+	void setupInstancedGeometry(osg::Geometry& geometry, const std::vector<osg::Matrixd>& instances, osg::StateSet* stateSet)
+	{
+		if (instances.empty()) {
+			return;
+		}
+
+		// 行向量矩阵 M 的第 i 列即列向量约定下仿射矩阵的第 i 行
+		osg::ref_ptr<osg::Vec4Array> rows[3] = { new osg::Vec4Array, new osg::Vec4Array, new osg::Vec4Array };
+		for (int row = 0; row < 3; ++row) {
+			rows[row]->reserve(instances.size());
+		}
+
+		const osg::BoundingBox& meshBound = geometry.getBoundingBox();
+		osg::BoundingBox instancedBound;
+		for (const osg::Matrixd& matrix : instances) {
+			for (int row = 0; row < 3; ++row) {
+				rows[row]->push_back(osg::Vec4(matrix(0, row), matrix(1, row), matrix(2, row), matrix(3, row)));
+			}
+			if (meshBound.valid()) {
+				for (unsigned int corner = 0; corner < 8; ++corner) {
+					instancedBound.expandBy(meshBound.corner(corner) * matrix);
+				}
+			}
+		}
+
+		geometry.setVertexAttribArray(INSTANCE_ROW0, rows[0].get(), osg::Array::BIND_PER_VERTEX);
+		geometry.setVertexAttribArray(INSTANCE_ROW1, rows[1].get(), osg::Array::BIND_PER_VERTEX);
+		geometry.setVertexAttribArray(INSTANCE_ROW2, rows[2].get(), osg::Array::BIND_PER_VERTEX);
+
+		for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i) {
+			geometry.getPrimitiveSet(i)->setNumInstances(static_cast<int>(instances.size()));
+		}
+
+		geometry.setStateSet(stateSet);
+
+		// 包围盒需要覆盖所有实例，否则会被错误剔除
+		geometry.setInitialBound(instancedBound);
+		geometry.dirtyBound();
+	}
+
+	unsigned int setupInstancedNode(osg::Node* node, const std::vector<osg::Matrixd>& instances, const InstancingStateSets& stateSets)
+	{
+		if (!node || instances.empty()) {
+			return 0;
+		}
+
+		InstancingVisitor visitor(instances, stateSets);
+		node->accept(visitor);
+		CO_TRACE("Instanced {} geometries with {} instances", visitor.count, instances.size());
+		return visitor.count;
+	}
+
+	bool isInstancedGeometry(const osg::Geometry& geometry)
+	{
+		for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i) {
+			if (geometry.getPrimitiveSet(i)->getNumInstances() > 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <osg/Matrixd>
+#include <osg/StateSet>
+
+#include <vector>
+
+namespace osg {
+	class Geometry;
+	class Node;
+}
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 实例化绘制使用的顶点属性位置（避开 OSG 固定管线别名使用的 0~7）
+	 * 每个实例的仿射变换按行存放在三个 vec4 属性中，属性除数为 1。
+	 */
+	enum InstanceAttributeLocation
+	{
+		INSTANCE_ROW0 = 10,
+		INSTANCE_ROW1 = 11,
+		INSTANCE_ROW2 = 12
+	};
+
+	/**
+	 * @brief 获取实例化绘制共享的 StateSet（着色器程序 + 属性除数），所有瓦片共用同一份
+	 * 着色器按固定管线的材质和第 0 个光源计算光照，textured 决定是否采样第 0 层纹理。
+	 */
+	osg::StateSet* getInstancingStateSet(bool textured);
+
+	/**
+	 * @brief 实例化几何体使用的 StateSet（按是否带纹理区分）
+	 * 共享的 StateSet 被所有瓦片同时绘制，加载线程中应传入占位的 StateSet，由主线程替换为 getInstancingStateSet()。
+	 */
+	struct InstancingStateSets
+	{
+		osg::ref_ptr<osg::StateSet> textured;
+		osg::ref_ptr<osg::StateSet> untextured;
+	};
+
+	/**
+	 * @brief 把几何体改为实例化绘制：写入每实例变换属性、设置图元实例数、StateSet 并扩展包围盒
+	 * instances 为相对于网格所在节点的实例变换（OSG 行向量约定，v' = v * M）。
+	 */
+	void setupInstancedGeometry(osg::Geometry& geometry, const std::vector<osg::Matrixd>& instances, osg::StateSet* stateSet);
+
+	/**
+	 * @brief 对子图中的所有几何体调用 setupInstancedGeometry，按几何体所在 Geode 的 StateSet 是否带纹理选择 StateSet
+	 * @return 被设置为实例化绘制的几何体数量
+	 */
+	unsigned int setupInstancedNode(osg::Node* node, const std::vector<osg::Matrixd>& instances, const InstancingStateSets& stateSets);
+
+	/**
+	 * @brief 几何体是否使用实例化绘制（其顶点不能再预乘节点变换或与其他几何体合并）
+	 */
+	bool isInstancedGeometry(const osg::Geometry& geometry);
+
+}	// namespace czmosg
@@ -0,0 +1,90 @@
+#include "LoadConcurrencyTuner.h"
+#include "Log.h"
+
+#include <algorithm>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 吞吐量至少提升该比例才认为增加并发数有效
+		constexpr double IMPROVEMENT = 1.05;
+		// 达到平台后保持的窗口数
+		constexpr uint32_t HOLD_WINDOWS = 10;
+	}
+
+	void LoadConcurrencyTuner::setRange(uint32_t minimum, uint32_t maximum)
+	{
+		m_minimum = std::max<uint32_t>(1, std::min(minimum, maximum));
+		m_maximum = std::max(m_minimum, maximum);
+	}
+
+	void LoadConcurrencyTuner::reset()
+	{
+		m_started = false;
+		m_throughput = 0.0;
+		m_latency = 0.0;
+		m_previousThroughput = 0.0;
+		m_increased = false;
+		m_holdWindows = 0;
+	}
+
+	uint32_t LoadConcurrencyTuner::update(uint32_t currentLoads, const Sample& sample)
+	{
+		const uint32_t clampedLoads = std::clamp(currentLoads, m_minimum, m_maximum);
+		if (!m_started) {
+			m_started = true;
+			m_windowStart = sample;
+			return clampedLoads;
+		}
+
+		const double elapsed = sample.time - m_windowStart.time;
+		if (elapsed < m_window) {
+			return clampedLoads;
+		}
+
+		const uint64_t requests = sample.requestsCompleted - m_windowStart.requestsCompleted;
+		const double requestTime = sample.requestTime - m_windowStart.requestTime;
+		m_windowStart = sample;
+
+		// 没有需求的窗口不能反映并发数的效果
+		if (sample.queuedLoads == 0 || requests == 0) {
+			m_increased = false;
+			return clampedLoads;
+		}
+
+		m_throughput = requests / elapsed;
+		m_latency = requestTime / requests;
+
+		uint32_t loads = clampedLoads;
+		if (m_latency > m_maximumLatency || sample.queuedTasks > 2 * uint64_t(clampedLoads)) {
+			// 请求排队、网络拥塞或后台任务积压，减少并发数
+			loads = std::max(m_minimum, clampedLoads - std::max<uint32_t>(1, clampedLoads / 4));
+			m_increased = false;
+			m_holdWindows = HOLD_WINDOWS;
+		}
+		else if (m_increased && m_throughput < m_previousThroughput * IMPROVEMENT) {
+			// 上一次增加没有带来明显提升，回退并保持一段时间
+			loads = std::max(m_minimum, clampedLoads - 1);
+			m_increased = false;
+			m_holdWindows = HOLD_WINDOWS;
+		}
+		else if (m_holdWindows > 0) {
+			--m_holdWindows;
+			m_increased = false;
+		}
+		else if (clampedLoads < m_maximum) {
+			loads = clampedLoads + 1;
+			m_increased = true;
+		}
+		m_previousThroughput = m_throughput;
+
+		if (loads != currentLoads) {
+			CO_DEBUG("Load concurrency: {} -> {} ({:.1f} requests/s, {:.0f} ms average latency, {} queued)",
+				currentLoads, loads, m_throughput, m_latency * 1000.0, sample.queuedLoads);
+		}
+		return loads;
+	}
+
+}	// namespace czmosg
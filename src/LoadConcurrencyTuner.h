@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 瓦片加载并发数的自动调整（爬山法）
+	 * 每个测量窗口统计请求吞吐量（每秒完成的请求数）和平均请求耗时：
+	 * 吞吐量随并发数提高而明显提升且耗时可接受时继续增加并发数；吞吐量不再提升时回退一步并保持；
+	 * 平均耗时超过上限或任务处理器积压（CPU 跟不上）时减少并发数。没有待加载的瓦片时不做调整，也不把空闲窗口当作吞吐量下降。
+	 */
+	class LoadConcurrencyTuner
+	{
+	public:
+		// 一次测量（累计值，由任务处理器和资源访问器提供）
+		struct Sample
+		{
+			// 当前时间（秒）
+			double time = 0.0;
+			// 累计完成的请求数和耗时（秒）
+			uint64_t requestsCompleted = 0;
+			double requestTime = 0.0;
+			// 排队等待加载的瓦片数
+			uint32_t queuedLoads = 0;
+			// 任务处理器中排队的任务数（解码、构建节点等 CPU 工作）
+			uint64_t queuedTasks = 0;
+		};
+
+		// 设置并发数的范围
+		void setRange(uint32_t minimum, uint32_t maximum);
+		uint32_t getMinimum() const { return m_minimum; }
+		uint32_t getMaximum() const { return m_maximum; }
+
+		// 设置可接受的平均请求耗时（秒）
+		void setMaximumLatency(double latency) { m_maximumLatency = latency; }
+		double getMaximumLatency() const { return m_maximumLatency; }
+
+		// 设置测量窗口长度（秒）
+		void setWindow(double window) { m_window = window; }
+		double getWindow() const { return m_window; }
+
+		// 获取最近一个窗口的吞吐量（请求/秒）和平均耗时（秒）
+		double getThroughput() const { return m_throughput; }
+		double getLatency() const { return m_latency; }
+
+		// 每帧调用，返回新的并发数（不需要调整时返回 currentLoads）
+		uint32_t update(uint32_t currentLoads, const Sample& sample);
+
+		// 丢弃测量状态
+		void reset();
+
+	private:
+		uint32_t m_minimum = 1;
+		uint32_t m_maximum = 32;
+		double m_maximumLatency = 2.0;
+		double m_window = 1.0;
+
+		bool m_started = false;
+		Sample m_windowStart;
+		double m_throughput = 0.0;
+		double m_latency = 0.0;
+		// 上一个有负载窗口的吞吐量，以及上一步是否为增加并发数
+		double m_previousThroughput = 0.0;
+		bool m_increased = false;
+		// 吞吐量达到平台后保持若干窗口再重新试探
+		uint32_t m_holdWindows = 0;
+	};
+
+}	// namespace czmosg
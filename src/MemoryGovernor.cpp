@@ -0,0 +1,225 @@
+#include "MemoryGovernor.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#endif
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 瓦片占用超过缓存预算的比例，或系统可用内存低于总内存的比例时进入对应的压力等级
+		constexpr double ELEVATED_USAGE = 0.9;
+		constexpr double CRITICAL_USAGE = 1.0;
+		constexpr double ELEVATED_AVAILABLE = 0.10;
+		constexpr double CRITICAL_AVAILABLE = 0.05;
+		// 降级时放宽的阈值，避免在阈值附近来回切换
+		constexpr double USAGE_HYSTERESIS = 0.05;
+		constexpr double AVAILABLE_HYSTERESIS = 0.03;
+		// 为系统和其它进程保留的内存比例，缓存预算不会占用这部分可用内存
+		constexpr double AVAILABLE_RESERVE = 0.10;
+		// 预算减小超过该比例才视为降低内存占用并发出事件
+		constexpr double SHED_THRESHOLD = 0.1;
+		// 各压力等级下的纹理宽高上限
+		constexpr unsigned int ELEVATED_TEXTURE_SIZE = 2048;
+		constexpr unsigned int CRITICAL_TEXTURE_SIZE = 1024;
+
+		const char* levelName(MemoryPressureLevel level)
+		{
+			switch (level) {
+			case MEMORY_PRESSURE_ELEVATED:
+				return "elevated";
+			case MEMORY_PRESSURE_CRITICAL:
+				return "critical";
+			default:
+				return "normal";
+			}
+		}
+
+		MemoryPressureLevel computeLevel(double usage, double availableRatio, MemoryPressureLevel current)
+		{
+			auto exceeds = [&](double usageThreshold, double availableThreshold, bool holding) {
+				if (holding) {
+					usageThreshold -= USAGE_HYSTERESIS;
+					availableThreshold += AVAILABLE_HYSTERESIS;
+				}
+				return usage > usageThreshold || availableRatio < availableThreshold;
+			};
+
+			if (exceeds(CRITICAL_USAGE, CRITICAL_AVAILABLE, current == MEMORY_PRESSURE_CRITICAL)) {
+				return MEMORY_PRESSURE_CRITICAL;
+			}
+			if (exceeds(ELEVATED_USAGE, ELEVATED_AVAILABLE, current != MEMORY_PRESSURE_NORMAL)) {
+				return MEMORY_PRESSURE_ELEVATED;
+			}
+			return MEMORY_PRESSURE_NORMAL;
+		}
+	}
+
+	bool MemoryGovernor::querySystemMemory(SystemMemory& memory)
+	{
+#if defined(_WIN32)
+		MEMORYSTATUSEX status;
+		status.dwLength = sizeof(status);
+		if (!GlobalMemoryStatusEx(&status)) {
+			return false;
+		}
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return false;
+		}
+		memory.totalBytes = status.ullTotalPhys;
+		memory.availableBytes = status.ullAvailPhys;
+		memory.processBytes = counters.WorkingSetSize;
+		return true;
+#elif defined(__linux__)
+		// /proc/meminfo 中的值以 kB 为单位；MemAvailable 包含可回收的页缓存
+		std::ifstream meminfo("/proc/meminfo");
+		uint64_t totalKB = 0;
+		uint64_t availableKB = 0;
+		bool hasTotal = false;
+		bool hasAvailable = false;
+		std::string key;
+		uint64_t value = 0;
+		std::string unit;
+		while (meminfo >> key >> value >> unit) {
+			if (key == "MemTotal:") {
+				totalKB = value;
+				hasTotal = true;
+			}
+			else if (key == "MemAvailable:") {
+				availableKB = value;
+				hasAvailable = true;
+			}
+			if (hasTotal && hasAvailable) {
+				break;
+			}
+		}
+		if (!hasTotal || !hasAvailable) {
+			return false;
+		}
+
+		// /proc/self/statm 的第二列为常驻页数
+		std::ifstream statm("/proc/self/statm");
+		uint64_t sizePages = 0;
+		uint64_t residentPages = 0;
+		if (!(statm >> sizePages >> residentPages)) {
+			return false;
+		}
+
+		memory.totalBytes = totalKB * 1024;
+		memory.availableBytes = availableKB * 1024;
+		memory.processBytes = residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+		return true;
+#else
+		(void)memory;
+		return false;
+#endif
+	}
+
+	void MemoryGovernor::setMemoryShare(double share)
+	{
+		m_memoryShare = std::clamp(share, 0.01, 1.0);
+	}
+
+	void MemoryGovernor::setCacheRange(int64_t minimum, int64_t maximum)
+	{
+		m_minimumCacheBytes = std::max<int64_t>(0, minimum);
+		m_maximumCacheBytes = maximum > 0 ? std::max(m_minimumCacheBytes, maximum) : 0;
+	}
+
+	unsigned int MemoryGovernor::getMaximumTextureSize() const
+	{
+		switch (m_level) {
+		case MEMORY_PRESSURE_ELEVATED:
+			return ELEVATED_TEXTURE_SIZE;
+		case MEMORY_PRESSURE_CRITICAL:
+			return CRITICAL_TEXTURE_SIZE;
+		default:
+			return 0;
+		}
+	}
+
+	void MemoryGovernor::reset()
+	{
+		m_started = false;
+		m_lastPollTime = 0.0;
+		m_memory = SystemMemory();
+		m_cacheBytes = 0;
+		m_level = MEMORY_PRESSURE_NORMAL;
+	}
+
+	bool MemoryGovernor::update(double time, int64_t tileBytes)
+	{
+		if (m_started && time - m_lastPollTime < m_pollInterval) {
+			return false;
+		}
+		m_started = true;
+		m_lastPollTime = time;
+
+		SystemMemory memory;
+		if (!querySystemMemory(memory) || memory.totalBytes == 0) {
+			return false;
+		}
+		m_memory = memory;
+
+		// 进程中瓦片以外的占用（程序本身、其它场景数据等）不受调节器控制，从预算中扣除
+		const int64_t budget = static_cast<int64_t>(m_memoryShare * static_cast<double>(memory.totalBytes));
+		const int64_t processBytes = static_cast<int64_t>(memory.processBytes);
+		const int64_t otherBytes = std::max<int64_t>(0, processBytes - tileBytes);
+		int64_t cacheBytes = budget - otherBytes;
+
+		// 系统可用内存不足（其它进程占用较多）时，缓存最多增长到可用内存扣除保留部分
+		const int64_t reserve = static_cast<int64_t>(AVAILABLE_RESERVE * static_cast<double>(memory.totalBytes));
+		cacheBytes = std::min(cacheBytes, tileBytes + static_cast<int64_t>(memory.availableBytes) - reserve);
+
+		const int64_t maximum = m_maximumCacheBytes > 0 ? m_maximumCacheBytes : std::numeric_limits<int64_t>::max();
+		cacheBytes = std::clamp(cacheBytes, m_minimumCacheBytes, std::max(m_minimumCacheBytes, maximum));
+
+		// 压力等级按瓦片自身的占用和它的缓存预算计算；整个进程的 RSS 还包含其它瓦片集和程序本身，不能与单个瓦片集的预算比较
+		const double usage = cacheBytes > 0 ? static_cast<double>(tileBytes) / static_cast<double>(cacheBytes) : 0.0;
+		const double availableRatio = static_cast<double>(memory.availableBytes) / static_cast<double>(memory.totalBytes);
+		const MemoryPressureLevel level = computeLevel(usage, availableRatio, m_level);
+
+		MemoryPressureEvent event;
+		event.level = level;
+		event.previousLevel = m_level;
+		event.cacheBytes = cacheBytes;
+		event.previousCacheBytes = m_cacheBytes;
+		event.memory = memory;
+
+		m_cacheBytes = cacheBytes;
+		m_level = level;
+		event.maximumTextureSize = getMaximumTextureSize();
+
+		const bool levelRaised = event.level > event.previousLevel;
+		const bool budgetShrunk = event.previousCacheBytes > 0 &&
+			event.cacheBytes < static_cast<int64_t>(event.previousCacheBytes * (1.0 - SHED_THRESHOLD));
+		if (levelRaised || budgetShrunk) {
+			CO_WARN("Memory pressure {}: cache budget {} -> {} MB, tiles {} MB, texture size limit {}, process {} MB, available {} / {} MB",
+				levelName(event.level), event.previousCacheBytes >> 20, event.cacheBytes >> 20, tileBytes >> 20,
+				event.maximumTextureSize, memory.processBytes >> 20, memory.availableBytes >> 20, memory.totalBytes >> 20);
+			if (m_eventCallback) {
+				m_eventCallback(event);
+			}
+		}
+		else if (event.level < event.previousLevel) {
+			CO_INFO("Memory pressure {}: cache budget {} MB", levelName(event.level), event.cacheBytes >> 20);
+		}
+		return true;
+	}
+
+}	// namespace czmosg
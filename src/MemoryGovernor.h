@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace czmosg
+{
+
+	// 内存压力等级
+	enum MemoryPressureLevel
+	{
+		MEMORY_PRESSURE_NORMAL,		// 瓦片占用在缓存预算内，不限制纹理尺寸
+		MEMORY_PRESSURE_ELEVATED,	// 接近预算或系统可用内存偏低，缩小大纹理
+		MEMORY_PRESSURE_CRITICAL	// 超出预算或系统可用内存不足，进一步缩小纹理
+	};
+
+	// 系统和进程的内存状况（字节）
+	struct SystemMemory
+	{
+		uint64_t totalBytes = 0;
+		uint64_t availableBytes = 0;
+		// 进程常驻内存（RSS / 工作集）
+		uint64_t processBytes = 0;
+	};
+
+	// 调节器降低内存占用（压力等级升高或缓存预算减小）时发出的事件
+	struct MemoryPressureEvent
+	{
+		MemoryPressureLevel level = MEMORY_PRESSURE_NORMAL;
+		MemoryPressureLevel previousLevel = MEMORY_PRESSURE_NORMAL;
+		int64_t cacheBytes = 0;
+		int64_t previousCacheBytes = 0;
+		// 新加载瓦片的纹理宽高上限，0 表示不限制
+		unsigned int maximumTextureSize = 0;
+		SystemMemory memory;
+	};
+
+	/**
+	 * @brief 内存压力调节器：按系统内存和进程占用调整瓦片缓存预算和纹理尺寸上限
+	 * 定期读取系统总内存、可用内存和进程 RSS（Linux 读取 /proc，Windows 使用 GlobalMemoryStatusEx），
+	 * 使进程总占用不超过系统内存的给定比例：缓存预算 = 比例 * 总内存 - 进程中瓦片以外的占用，
+	 * 同时不超过系统当前可用内存允许的大小。瓦片占用（tileBytes）接近或超出缓存预算、或系统可用内存偏低时提高压力等级，
+	 * 新加载的瓦片使用更小的纹理。
+	 * 不支持的平台上 update() 不做任何调整。
+	 */
+	class MemoryGovernor
+	{
+	public:
+		using EventCallback = std::function<void(const MemoryPressureEvent&)>;
+
+		// 读取当前的系统和进程内存，不支持的平台返回 false
+		static bool querySystemMemory(SystemMemory& memory);
+
+		// 设置进程可以使用的系统内存比例（默认 0.5）
+		void setMemoryShare(double share);
+		double getMemoryShare() const { return m_memoryShare; }
+
+		// 设置缓存预算的范围（默认 32 MB 以上，maximum 为 0 表示不设上限）
+		void setCacheRange(int64_t minimum, int64_t maximum);
+		int64_t getMinimumCacheBytes() const { return m_minimumCacheBytes; }
+		int64_t getMaximumCacheBytes() const { return m_maximumCacheBytes; }
+
+		// 设置读取内存状况的间隔（秒，默认 1）
+		void setPollInterval(double interval) { m_pollInterval = interval; }
+		double getPollInterval() const { return m_pollInterval; }
+
+		// 设置降低内存占用时的回调
+		void setEventCallback(EventCallback callback) { m_eventCallback = std::move(callback); }
+
+		// 每帧调用，tileBytes 为瓦片当前占用的字节数；到达间隔并重新计算了预算时返回 true
+		bool update(double time, int64_t tileBytes);
+
+		// 最近一次计算的缓存预算、纹理尺寸上限和压力等级
+		int64_t getCacheBytes() const { return m_cacheBytes; }
+		unsigned int getMaximumTextureSize() const;
+		MemoryPressureLevel getLevel() const { return m_level; }
+
+		// 最近一次读取的内存状况
+		const SystemMemory& getSystemMemory() const { return m_memory; }
+
+		// 丢弃计时和上一次的结果
+		void reset();
+
+	private:
+		double m_memoryShare = 0.5;
+		int64_t m_minimumCacheBytes = 32 * 1024 * 1024;
+		int64_t m_maximumCacheBytes = 0;
+		double m_pollInterval = 1.0;
+		EventCallback m_eventCallback;
+
+		bool m_started = false;
+		double m_lastPollTime = 0.0;
+		SystemMemory m_memory;
+		int64_t m_cacheBytes = 0;
+		MemoryPressureLevel m_level = MEMORY_PRESSURE_NORMAL;
+	};
+
+}	// namespace czmosg
@@ -0,0 +1,225 @@
+#include "MemoryUsage.h"
+
+#include <CesiumGltf/ImageAsset.h>
+#include <CesiumGltf/Model.h>
+#include <CesiumUtility/IntrusivePointer.h>
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/Image>
+#include <osg/Material>
+#include <osg/MatrixTransform>
+#include <osg/NodeVisitor>
+#include <osg/StateSet>
+#include <osg/Texture2D>
+
+#include <vector>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 数组对象本身的大小按实际类型取 sizeof，列出瓦片中会创建的数组类型，其余按基类计
+		size_t arrayObjectSize(const osg::Array& array)
+		{
+			switch (array.getType()) {
+			case osg::Array::UByteArrayType: return sizeof(osg::UByteArray);
+			case osg::Array::UShortArrayType: return sizeof(osg::UShortArray);
+			case osg::Array::UIntArrayType: return sizeof(osg::UIntArray);
+			case osg::Array::FloatArrayType: return sizeof(osg::FloatArray);
+			case osg::Array::Vec2ArrayType: return sizeof(osg::Vec2Array);
+			case osg::Array::Vec3ArrayType: return sizeof(osg::Vec3Array);
+			case osg::Array::Vec4ArrayType: return sizeof(osg::Vec4Array);
+			case osg::Array::Vec3bArrayType: return sizeof(osg::Vec3bArray);
+			case osg::Array::Vec3sArrayType: return sizeof(osg::Vec3sArray);
+			case osg::Array::Vec3ubArrayType: return sizeof(osg::Vec3ubArray);
+			case osg::Array::Vec4ubArrayType: return sizeof(osg::Vec4ubArray);
+			case osg::Array::Vec3usArrayType: return sizeof(osg::Vec3usArray);
+			case osg::Array::Vec4usArrayType: return sizeof(osg::Vec4usArray);
+			default: return sizeof(osg::Array);
+			}
+		}
+
+		// 图元对象本身的大小按实际类型取 sizeof
+		size_t primitiveSetObjectSize(const osg::PrimitiveSet& primitiveSet)
+		{
+			switch (primitiveSet.getType()) {
+			case osg::PrimitiveSet::DrawArraysPrimitiveType: return sizeof(osg::DrawArrays);
+			case osg::PrimitiveSet::DrawArrayLengthsPrimitiveType: return sizeof(osg::DrawArrayLengths);
+			case osg::PrimitiveSet::DrawElementsUBytePrimitiveType: return sizeof(osg::DrawElementsUByte);
+			case osg::PrimitiveSet::DrawElementsUShortPrimitiveType: return sizeof(osg::DrawElementsUShort);
+			case osg::PrimitiveSet::DrawElementsUIntPrimitiveType: return sizeof(osg::DrawElementsUInt);
+			default: return sizeof(osg::PrimitiveSet);
+			}
+		}
+
+		// 状态属性对象本身的大小：瓦片独占的属性只有材质和纹理，其余按基类计
+		size_t attributeObjectSize(const osg::StateAttribute& attribute)
+		{
+			if (dynamic_cast<const osg::Material*>(&attribute)) {
+				return sizeof(osg::Material);
+			}
+			if (dynamic_cast<const osg::Texture2D*>(&attribute)) {
+				return sizeof(osg::Texture2D);
+			}
+			if (attribute.asTexture()) {
+				return sizeof(osg::Texture);
+			}
+			return sizeof(osg::StateAttribute);
+		}
+
+		class ByteSizeVisitor : public osg::NodeVisitor
+		{
+		public:
+			explicit ByteSizeVisitor(const std::set<const osg::Referenced*>* exclude)
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+				, m_exclude(exclude)
+			{
+			}
+
+			void apply(osg::Node& node) override
+			{
+				size.objects += sizeof(osg::Group);
+				applyStateSet(node.getStateSet());
+				traverse(node);
+			}
+
+			void apply(osg::Geode& geode) override
+			{
+				size.objects += sizeof(osg::Geode);
+				applyStateSet(geode.getStateSet());
+				traverse(geode);
+			}
+
+			void apply(osg::Transform& transform) override
+			{
+				size.objects += transform.asMatrixTransform() ? sizeof(osg::MatrixTransform) : sizeof(osg::Transform);
+				applyStateSet(transform.getStateSet());
+				traverse(transform);
+			}
+
+			void apply(osg::Drawable& drawable) override
+			{
+				applyStateSet(drawable.getStateSet());
+
+				osg::Geometry* geometry = drawable.asGeometry();
+				if (!geometry) {
+					size.objects += sizeof(osg::Drawable);
+					return;
+				}
+
+				size.objects += sizeof(osg::Geometry);
+				applyArray(geometry->getVertexArray());
+				applyArray(geometry->getNormalArray());
+				applyArray(geometry->getColorArray());
+				for (unsigned int i = 0; i < geometry->getNumTexCoordArrays(); ++i) {
+					applyArray(geometry->getTexCoordArray(i));
+				}
+				for (unsigned int i = 0; i < geometry->getNumVertexAttribArrays(); ++i) {
+					applyArray(geometry->getVertexAttribArray(i));
+				}
+				for (unsigned int i = 0; i < geometry->getNumPrimitiveSets(); ++i) {
+					const osg::PrimitiveSet* primitiveSet = geometry->getPrimitiveSet(i);
+					if (!visit(primitiveSet)) {
+						continue;
+					}
+					size.objects += primitiveSetObjectSize(*primitiveSet);
+					if (const osg::DrawElements* drawElements = primitiveSet->getDrawElements()) {
+						size.geometry += drawElements->getTotalDataSize();
+					}
+					else if (const osg::DrawArrayLengths* drawArrayLengths = dynamic_cast<const osg::DrawArrayLengths*>(primitiveSet)) {
+						size.geometry += drawArrayLengths->size() * sizeof(GLint);
+					}
+				}
+			}
+
+			NodeByteSize size;
+
+		private:
+			// 首次访问且不在排除列表中时返回 true
+			bool visit(const osg::Referenced* object)
+			{
+				if (m_exclude && m_exclude->count(object)) {
+					return false;
+				}
+				return m_visited.insert(object).second;
+			}
+
+			void applyArray(const osg::Array* array)
+			{
+				if (array && visit(array)) {
+					size.objects += arrayObjectSize(*array);
+					size.geometry += array->getTotalDataSize();
+				}
+			}
+
+			void applyStateSet(const osg::StateSet* stateSet)
+			{
+				if (!stateSet || !visit(stateSet)) {
+					return;
+				}
+
+				size.objects += sizeof(osg::StateSet);
+				for (const auto& [type, attribute] : stateSet->getAttributeList()) {
+					if (visit(attribute.first.get())) {
+						size.objects += attributeObjectSize(*attribute.first);
+					}
+				}
+
+				for (const auto& attributes : stateSet->getTextureAttributeList()) {
+					for (const auto& [type, attribute] : attributes) {
+						const osg::Texture* texture = attribute.first->asTexture();
+						if (!texture || !visit(texture)) {
+							continue;
+						}
+						size.objects += attributeObjectSize(*texture);
+						for (unsigned int i = 0; i < texture->getNumImages(); ++i) {
+							const osg::Image* image = texture->getImage(i);
+							if (image && visit(image)) {
+								size.objects += sizeof(osg::Image);
+								size.textures += image->getTotalSizeInBytes();
+							}
+						}
+					}
+				}
+			}
+
+			const std::set<const osg::Referenced*>* m_exclude;
+			std::set<const osg::Referenced*> m_visited;
+		};
+	}
+
+	NodeByteSize computeNodeByteSize(osg::Node* node, const std::set<const osg::Referenced*>* exclude)
+	{
+		if (!node) {
+			return NodeByteSize();
+		}
+
+		ByteSizeVisitor visitor(exclude);
+		node->accept(visitor);
+		return visitor.size;
+	}
+
+	uint64_t releaseModelData(CesiumGltf::Model& model)
+	{
+		uint64_t bytes = 0;
+
+		for (CesiumGltf::Buffer& buffer : model.buffers) {
+			bytes += buffer.cesium.data.size();
+			std::vector<std::byte>().swap(buffer.cesium.data);
+		}
+
+		for (CesiumGltf::Image& image : model.images) {
+			if (image.pAsset) {
+				bytes += image.pAsset->pixelData.size();
+				image.pAsset = CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset>();
+			}
+			// Tile::computeByteSize 会从缓冲区大小中扣除图像所在的 bufferView，缓冲区清空后不能再扣除
+			image.bufferView = -1;
+		}
+
+		return bytes;
+	}
+
+}	// namespace czmosg
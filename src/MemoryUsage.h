@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+namespace osg {
+	class Node;
+	class Referenced;
+}
+
+namespace CesiumGltf {
+	struct Model;
+}
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 子图中 OSG 资源占用的字节数（CPU 内存）
+	 * 数据部分按数组、索引和图像的实际数据大小统计；对象部分按各对象实际类型的 sizeof 统计，
+	 * 不含堆分配器的额外开销和 vector 预留的空闲容量，因此总数是略偏低的估计值。
+	 */
+	struct NodeByteSize
+	{
+		// 顶点数组和索引数据
+		uint64_t geometry = 0;
+		// 纹理图像的像素数据
+		uint64_t textures = 0;
+		// 节点、Drawable、图元、StateSet 和状态属性对象本身
+		uint64_t objects = 0;
+
+		uint64_t total() const { return geometry + textures + objects; }
+
+		NodeByteSize& operator+=(const NodeByteSize& other)
+		{
+			geometry += other.geometry;
+			textures += other.textures;
+			objects += other.objects;
+			return *this;
+		}
+
+		NodeByteSize& operator-=(const NodeByteSize& other)
+		{
+			geometry -= other.geometry;
+			textures -= other.textures;
+			objects -= other.objects;
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief 统计子图中 OSG 资源占用的字节数，同一对象只计一次
+	 * exclude 中的对象（例如从其他瓦片共享来的纹理）不计入，避免在多个瓦片中重复统计。
+	 */
+	NodeByteSize computeNodeByteSize(osg::Node* node, const std::set<const osg::Referenced*>* exclude = nullptr);
+
+	/**
+	 * @brief 释放 glTF 模型中已转换为 OSG 资源的缓冲区数据和解码后的图像
+	 * 只保留 cesium-native 仍需要的结构信息（节点、网格、访问器等元数据），
+	 * 释放后依赖模型几何数据的功能（如高度采样）不再可用。
+	 * @return 释放的字节数
+	 */
+	uint64_t releaseModelData(CesiumGltf::Model& model);
+
+}	// namespace czmosg
@@ -0,0 +1,471 @@
+#include "MeshOptimizer.h"
+#include "Log.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/NodeVisitor>
+#include <osgUtil/MeshOptimizers>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 仅当几何体的所有图元都是三角形类图元时才进行优化，
+		// osgUtil::VertexCacheVisitor 会把图元统一转换为三角形列表，点/线会丢失。
+		// 实例化几何体的每实例属性也是逐顶点绑定的，重排顶点会破坏它们，同样跳过
+		bool isTriangleGeometry(const osg::Geometry& geometry)
+		{
+			if (!geometry.getVertexArray() || geometry.getNumPrimitiveSets() == 0) {
+				return false;
+			}
+
+			for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i) {
+				const osg::PrimitiveSet* primitiveSet = geometry.getPrimitiveSet(i);
+				if (primitiveSet->getNumInstances() > 0) {
+					return false;
+				}
+				switch (primitiveSet->getMode()) {
+				case osg::PrimitiveSet::TRIANGLES:
+				case osg::PrimitiveSet::TRIANGLE_STRIP:
+				case osg::PrimitiveSet::TRIANGLE_FAN:
+					break;
+				default:
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// VertexCacheVisitor 输出的是 DrawElementsUInt，顶点数允许时转回 16 位索引以节省内存
+		void shrinkIndicesToUShort(osg::Geometry& geometry)
+		{
+			if (geometry.getVertexArray()->getNumElements() >= std::numeric_limits<unsigned short>::max()) {
+				return;
+			}
+
+			for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i) {
+				osg::DrawElementsUInt* drawElements = dynamic_cast<osg::DrawElementsUInt*>(geometry.getPrimitiveSet(i));
+				if (!drawElements) {
+					continue;
+				}
+
+				osg::ref_ptr<osg::DrawElementsUShort> shortElements = new osg::DrawElementsUShort(drawElements->getMode());
+				shortElements->reserve(drawElements->size());
+				for (unsigned int index : *drawElements) {
+					shortElements->push_back(static_cast<unsigned short>(index));
+				}
+				geometry.setPrimitiveSet(i, shortElements.get());
+			}
+		}
+
+		class VertexCacheOptimizeVisitor : public osg::NodeVisitor
+		{
+		public:
+			explicit VertexCacheOptimizeVisitor(unsigned int cacheSize)
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+				, m_cacheSize(cacheSize)
+			{
+			}
+
+			void apply(osg::Geometry& geometry) override
+			{
+				m_statistics += optimizeVertexCache(geometry, m_cacheSize);
+			}
+
+			const VertexCacheStatistics& getStatistics() const { return m_statistics; }
+
+		private:
+			unsigned int m_cacheSize;
+			VertexCacheStatistics m_statistics;
+		};
+
+		// 几何体合并的分组键：只有 StateSet、图元模式和顶点属性布局都相同的几何体才能拼接
+		struct MergeKey
+		{
+			const osg::StateSet* stateSet = nullptr;
+			GLenum mode = GL_TRIANGLES;
+			bool hasNormals = false;
+			bool hasTexCoords = false;
+
+			bool operator<(const MergeKey& other) const
+			{
+				return std::tie(stateSet, mode, hasNormals, hasTexCoords) <
+					std::tie(other.stateSet, other.mode, other.hasNormals, other.hasTexCoords);
+			}
+		};
+
+		// 判断几何体能否参与合并并计算分组键。只接受 NodeBuilder 生成的布局：
+		// Vec3 顶点、可选的逐顶点 Vec3 法线和 Vec2 纹理坐标，图元为同一种非条带模式
+		bool getMergeKey(const osg::Geometry& geometry, const osg::StateSet* stateSet, MergeKey& key)
+		{
+			const osg::Vec3Array* vertices = dynamic_cast<const osg::Vec3Array*>(geometry.getVertexArray());
+			if (!vertices || vertices->empty() || geometry.getNumPrimitiveSets() == 0) {
+				return false;
+			}
+			if (geometry.getColorArray() || geometry.getSecondaryColorArray() || geometry.getFogCoordArray() ||
+				geometry.getNumVertexAttribArrays() > 0 || geometry.getNumTexCoordArrays() > 1) {
+				return false;
+			}
+
+			const osg::Array* normals = geometry.getNormalArray();
+			if (normals && (!dynamic_cast<const osg::Vec3Array*>(normals) || normals->getBinding() != osg::Array::BIND_PER_VERTEX ||
+				normals->getNumElements() != vertices->size())) {
+				return false;
+			}
+
+			const osg::Array* texCoords = geometry.getTexCoordArray(0);
+			if (texCoords && (!dynamic_cast<const osg::Vec2Array*>(texCoords) || texCoords->getNumElements() != vertices->size())) {
+				return false;
+			}
+
+			GLenum mode = geometry.getPrimitiveSet(0)->getMode();
+			if (mode != osg::PrimitiveSet::TRIANGLES && mode != osg::PrimitiveSet::LINES && mode != osg::PrimitiveSet::POINTS) {
+				return false;
+			}
+			for (unsigned int i = 0; i < geometry.getNumPrimitiveSets(); ++i) {
+				const osg::PrimitiveSet* primitiveSet = geometry.getPrimitiveSet(i);
+				if (primitiveSet->getMode() != mode || primitiveSet->getNumInstances() > 0) {
+					return false;
+				}
+				if (primitiveSet->getType() != osg::PrimitiveSet::DrawArraysPrimitiveType &&
+					!primitiveSet->getDrawElements()) {
+					return false;
+				}
+			}
+
+			key.stateSet = stateSet;
+			key.mode = mode;
+			key.hasNormals = normals != nullptr;
+			key.hasTexCoords = texCoords != nullptr;
+			return true;
+		}
+
+		// 将同组几何体的顶点和索引拼接为一个几何体
+		osg::ref_ptr<osg::Geometry> concatenateGeometries(const MergeKey& key, const std::vector<osg::Geometry*>& geometries)
+		{
+			osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+			osg::ref_ptr<osg::Vec3Array> normals = key.hasNormals ? new osg::Vec3Array : nullptr;
+			osg::ref_ptr<osg::Vec2Array> texCoords = key.hasTexCoords ? new osg::Vec2Array : nullptr;
+			std::vector<unsigned int> indices;
+
+			for (osg::Geometry* geometry : geometries) {
+				const osg::Vec3Array* sourceVertices = static_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+				const unsigned int baseVertex = static_cast<unsigned int>(vertices->size());
+
+				vertices->insert(vertices->end(), sourceVertices->begin(), sourceVertices->end());
+				if (normals) {
+					const osg::Vec3Array* sourceNormals = static_cast<const osg::Vec3Array*>(geometry->getNormalArray());
+					normals->insert(normals->end(), sourceNormals->begin(), sourceNormals->end());
+				}
+				if (texCoords) {
+					const osg::Vec2Array* sourceTexCoords = static_cast<const osg::Vec2Array*>(geometry->getTexCoordArray(0));
+					texCoords->insert(texCoords->end(), sourceTexCoords->begin(), sourceTexCoords->end());
+				}
+
+				for (unsigned int i = 0; i < geometry->getNumPrimitiveSets(); ++i) {
+					const osg::PrimitiveSet* primitiveSet = geometry->getPrimitiveSet(i);
+					if (const osg::DrawElements* drawElements = primitiveSet->getDrawElements()) {
+						for (unsigned int j = 0; j < drawElements->getNumIndices(); ++j) {
+							indices.push_back(baseVertex + drawElements->index(j));
+						}
+					}
+					else {
+						const osg::DrawArrays* drawArrays = static_cast<const osg::DrawArrays*>(primitiveSet);
+						for (GLsizei j = 0; j < drawArrays->getCount(); ++j) {
+							indices.push_back(baseVertex + static_cast<unsigned int>(drawArrays->getFirst() + j));
+						}
+					}
+				}
+			}
+
+			osg::ref_ptr<osg::Geometry> merged = new osg::Geometry;
+			merged->setUseDisplayList(false);
+			merged->setUseVertexBufferObjects(true);
+			merged->setStateSet(const_cast<osg::StateSet*>(key.stateSet));
+			merged->setVertexArray(vertices.get());
+			if (normals) {
+				merged->setNormalArray(normals.get(), osg::Array::BIND_PER_VERTEX);
+			}
+			if (texCoords) {
+				merged->setTexCoordArray(0, texCoords.get(), osg::Array::BIND_PER_VERTEX);
+			}
+
+			// 顶点数超出 16 位索引范围时改用 32 位索引
+			if (vertices->size() > std::numeric_limits<unsigned short>::max()) {
+				merged->addPrimitiveSet(new osg::DrawElementsUInt(key.mode, indices.begin(), indices.end()));
+			}
+			else {
+				osg::ref_ptr<osg::DrawElementsUShort> drawElements = new osg::DrawElementsUShort(key.mode);
+				drawElements->reserve(indices.size());
+				for (unsigned int index : indices) {
+					drawElements->push_back(static_cast<unsigned short>(index));
+				}
+				merged->addPrimitiveSet(drawElements.get());
+			}
+			return merged;
+		}
+
+		// 以 Group 为单位合并：同一 Group 的子 Geode 没有额外的变换，其中的几何体处于同一坐标系
+		class GeometryMergeVisitor : public osg::NodeVisitor
+		{
+		public:
+			GeometryMergeVisitor()
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+			{
+			}
+
+			void apply(osg::Geode&) override
+			{
+				// Geode 中的几何体由其父 Group 统一合并
+			}
+
+			void apply(osg::Group& group) override
+			{
+				traverse(group);
+				mergeChildren(group);
+			}
+
+			const GeometryMergeStatistics& getStatistics() const { return m_statistics; }
+
+		private:
+			void mergeChildren(osg::Group& group)
+			{
+				std::vector<osg::Geode*> geodes;
+				std::map<MergeKey, std::vector<osg::Geometry*>> groups;
+				// 不能拼接的 Drawable 及其所在 Geode 的 StateSet（移入合并后的 Geode 时下移到 Drawable 上）
+				std::vector<std::pair<osg::ref_ptr<osg::Drawable>, osg::StateSet*>> unmerged;
+				unsigned int geometryCount = 0;
+
+				for (unsigned int i = 0; i < group.getNumChildren(); ++i) {
+					osg::Geode* geode = group.getChild(i)->asGeode();
+					if (!geode || geode->getNumParents() != 1 || geode->getUpdateCallback() || geode->getCullCallback()) {
+						continue;
+					}
+
+					// Geode 与其中的 Drawable 同时带 StateSet 时两者会叠加，无法把 Geode 的状态下移，整个 Geode 保持原样
+					osg::StateSet* geodeStateSet = geode->getStateSet();
+					bool layeredStateSets = false;
+					for (unsigned int j = 0; j < geode->getNumDrawables() && geodeStateSet; ++j) {
+						layeredStateSets = layeredStateSets || geode->getDrawable(j)->getStateSet() != nullptr;
+					}
+					if (layeredStateSets) {
+						continue;
+					}
+					geodes.push_back(geode);
+
+					for (unsigned int j = 0; j < geode->getNumDrawables(); ++j) {
+						osg::Drawable* drawable = geode->getDrawable(j);
+						osg::Geometry* geometry = drawable->asGeometry();
+						if (geometry) {
+							++geometryCount;
+						}
+
+						// 此时 Drawable 与 Geode 至多一个带 StateSet，按其中一个分组
+						const osg::StateSet* stateSet = drawable->getStateSet() ? drawable->getStateSet() : geodeStateSet;
+						MergeKey key;
+						if (!geometry || !getMergeKey(*geometry, stateSet, key)) {
+							unmerged.emplace_back(drawable, geodeStateSet);
+							continue;
+						}
+						groups[key].push_back(geometry);
+					}
+				}
+
+				// 没有可拼接的几何体时保持原结构
+				bool hasMerge = false;
+				for (const auto& [key, geometries] : groups) {
+					hasMerge = hasMerge || geometries.size() > 1;
+				}
+				if (!hasMerge) {
+					m_statistics.geometriesBefore += geometryCount;
+					m_statistics.geometriesAfter += geometryCount;
+					return;
+				}
+
+				osg::ref_ptr<osg::Geode> mergedGeode = new osg::Geode;
+				unsigned int mergedCount = 0;
+				for (auto& [key, geometries] : groups) {
+					if (geometries.size() == 1) {
+						geometries.front()->setStateSet(const_cast<osg::StateSet*>(key.stateSet));
+						mergedGeode->addDrawable(geometries.front());
+					}
+					else {
+						mergedGeode->addDrawable(concatenateGeometries(key, geometries).get());
+					}
+					++mergedCount;
+				}
+				for (auto& [drawable, geodeStateSet] : unmerged) {
+					if (geodeStateSet) {
+						drawable->setStateSet(geodeStateSet);
+					}
+					mergedGeode->addDrawable(drawable.get());
+					if (drawable->asGeometry()) {
+						++mergedCount;
+					}
+				}
+
+				for (osg::Geode* geode : geodes) {
+					group.removeChild(geode);
+				}
+				if (mergedGeode->getNumDrawables() > 0) {
+					group.addChild(mergedGeode.get());
+				}
+
+				m_statistics.geometriesBefore += geometryCount;
+				m_statistics.geometriesAfter += mergedCount;
+			}
+
+			GeometryMergeStatistics m_statistics;
+		};
+
+		class TriangleCountVisitor : public osg::NodeVisitor
+		{
+		public:
+			TriangleCountVisitor()
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+			{
+			}
+
+			void apply(osg::Drawable& drawable) override
+			{
+				osg::Geometry* geometry = drawable.asGeometry();
+				if (!geometry) {
+					return;
+				}
+
+				for (unsigned int i = 0; i < geometry->getNumPrimitiveSets(); ++i) {
+					const osg::PrimitiveSet* primitiveSet = geometry->getPrimitiveSet(i);
+					const uint64_t indices = primitiveSet->getNumIndices();
+					uint64_t count = 0;
+					switch (primitiveSet->getMode()) {
+					case osg::PrimitiveSet::TRIANGLES:
+						count = indices / 3;
+						break;
+					case osg::PrimitiveSet::TRIANGLE_STRIP:
+					case osg::PrimitiveSet::TRIANGLE_FAN:
+						count = indices > 2 ? indices - 2 : 0;
+						break;
+					default:
+						break;
+					}
+					triangles += count * std::max(1, primitiveSet->getNumInstances());
+				}
+			}
+
+			uint64_t triangles = 0;
+		};
+	}
+
+	VertexCacheStatistics optimizeVertexCache(osg::Geometry& geometry, unsigned int cacheSize)
+	{
+		VertexCacheStatistics statistics;
+		if (!isTriangleGeometry(geometry)) {
+			return statistics;
+		}
+
+		osgUtil::VertexCacheMissVisitor missBefore(cacheSize);
+		missBefore.doGeometry(geometry);
+
+		// Forsyth 三角形重排，提高后变换顶点缓存命中率
+		osgUtil::VertexCacheVisitor cacheVisitor;
+		cacheVisitor.optimizeVertices(geometry);
+
+		// 按首次引用顺序重排顶点数组，提高顶点读取的局部性
+		osgUtil::VertexAccessOrderVisitor orderVisitor;
+		orderVisitor.optimizeOrder(geometry);
+
+		shrinkIndicesToUShort(geometry);
+
+		osgUtil::VertexCacheMissVisitor missAfter(cacheSize);
+		missAfter.doGeometry(geometry);
+
+		statistics.geometries = 1;
+		statistics.triangles = missAfter.triangles;
+		statistics.missesBefore = missBefore.misses;
+		statistics.missesAfter = missAfter.misses;
+		return statistics;
+	}
+
+	VertexCacheStatistics optimizeVertexCache(osg::Node* node, unsigned int cacheSize)
+	{
+		if (!node) {
+			return VertexCacheStatistics();
+		}
+
+		VertexCacheOptimizeVisitor visitor(cacheSize);
+		node->accept(visitor);
+
+		const VertexCacheStatistics& statistics = visitor.getStatistics();
+		CO_TRACE("Vertex cache optimized {} geometries, {} triangles", statistics.geometries, statistics.triangles);
+		return statistics;
+	}
+
+	bool transformGeometry(osg::Geometry& geometry, const osg::Matrixd& matrix)
+	{
+		osg::Vec3Array* vertices = dynamic_cast<osg::Vec3Array*>(geometry.getVertexArray());
+		if (!vertices) {
+			return false;
+		}
+
+		// 镜像变换会翻转三角形绕序，预乘后背面剔除会出错
+		const double determinant =
+			matrix(0, 0) * (matrix(1, 1) * matrix(2, 2) - matrix(1, 2) * matrix(2, 1)) -
+			matrix(0, 1) * (matrix(1, 0) * matrix(2, 2) - matrix(1, 2) * matrix(2, 0)) +
+			matrix(0, 2) * (matrix(1, 0) * matrix(2, 1) - matrix(1, 1) * matrix(2, 0));
+		if (determinant <= 0.0) {
+			return false;
+		}
+
+		for (osg::Vec3& vertex : *vertices) {
+			vertex = vertex * matrix;
+		}
+		vertices->dirty();
+
+		osg::Vec3Array* normals = dynamic_cast<osg::Vec3Array*>(geometry.getNormalArray());
+		if (normals) {
+			// 法线使用逆矩阵的转置变换
+			const osg::Matrixd inverse = osg::Matrixd::inverse(matrix);
+			for (osg::Vec3& normal : *normals) {
+				normal = osg::Matrixd::transform3x3(inverse, normal);
+				normal.normalize();
+			}
+			normals->dirty();
+		}
+
+		geometry.dirtyBound();
+		return true;
+	}
+
+	uint64_t countTriangles(osg::Node* node)
+	{
+		if (!node) {
+			return 0;
+		}
+
+		TriangleCountVisitor visitor;
+		node->accept(visitor);
+		return visitor.triangles;
+	}
+
+	GeometryMergeStatistics mergeGeometries(osg::Node* node)
+	{
+		if (!node) {
+			return GeometryMergeStatistics();
+		}
+
+		GeometryMergeVisitor visitor;
+		node->accept(visitor);
+
+		const GeometryMergeStatistics& statistics = visitor.getStatistics();
+		CO_TRACE("Merged {} geometries into {}", statistics.geometriesBefore, statistics.geometriesAfter);
+		return statistics;
+	}
+
+}	// namespace czmosg
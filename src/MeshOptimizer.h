@@ -0,0 +1,85 @@
+#pragma once
+
+#include <osg/Matrixd>
+
+#include <cstdint>
+
+namespace osg {
+	class Node;
+	class Geometry;
+}
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 顶点缓存优化的统计结果
+	 * ACMR（Average Cache Miss Ratio）= 缓存未命中次数 / 三角形数，越小越好（理想值约 0.5~0.7）
+	 */
+	struct VertexCacheStatistics
+	{
+		unsigned int geometries = 0;
+		unsigned int triangles = 0;
+		unsigned int missesBefore = 0;
+		unsigned int missesAfter = 0;
+
+		double acmrBefore() const { return triangles > 0 ? double(missesBefore) / triangles : 0.0; }
+		double acmrAfter() const { return triangles > 0 ? double(missesAfter) / triangles : 0.0; }
+
+		VertexCacheStatistics& operator+=(const VertexCacheStatistics& other)
+		{
+			geometries += other.geometries;
+			triangles += other.triangles;
+			missesBefore += other.missesBefore;
+			missesAfter += other.missesAfter;
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief 几何体合并的统计结果
+	 */
+	struct GeometryMergeStatistics
+	{
+		unsigned int geometriesBefore = 0;
+		unsigned int geometriesAfter = 0;
+
+		GeometryMergeStatistics& operator+=(const GeometryMergeStatistics& other)
+		{
+			geometriesBefore += other.geometriesBefore;
+			geometriesAfter += other.geometriesAfter;
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief 对单个几何体做顶点缓存优化（Forsyth 三角形重排）和顶点访问顺序优化
+	 * 只处理三角形图元，含点/线图元的几何体保持原样。不需要 GL 上下文，可在加载线程中执行。
+	 */
+	VertexCacheStatistics optimizeVertexCache(osg::Geometry& geometry, unsigned int cacheSize = 16);
+
+	/**
+	 * @brief 遍历子图，对其中所有几何体执行 optimizeVertexCache
+	 */
+	VertexCacheStatistics optimizeVertexCache(osg::Node* node, unsigned int cacheSize = 16);
+
+	/**
+	 * @brief 将变换预乘进几何体的顶点和法线（法线使用逆转置矩阵）
+	 * 顶点不是 Vec3Array，或矩阵为镜像变换（会翻转三角形绕序）时不做修改并返回 false。
+	 */
+	bool transformGeometry(osg::Geometry& geometry, const osg::Matrixd& matrix);
+
+	/**
+	 * @brief 合并子图中处于同一坐标系下、StateSet 相同且顶点属性布局相同的几何体
+	 * 同一 Group 下各 Geode 中的几何体按（StateSet, 图元模式, 属性布局）分组，每组拼接为一个几何体，
+	 * 顶点总数超过 65535 时使用 32 位索引。跨变换节点的合并需要先压平层级（NodeBuilder::setFlattenHierarchy）。
+	 * 不需要 GL 上下文，可在加载线程中执行。
+	 */
+	GeometryMergeStatistics mergeGeometries(osg::Node* node);
+
+	/**
+	 * @brief 统计子图中绘制的三角形数（三角形、三角形带和扇形图元，实例化绘制按实例数计）
+	 */
+	uint64_t countTriangles(osg::Node* node);
+
+}	// namespace czmosg
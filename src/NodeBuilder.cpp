@@ -1,20 +1,32 @@
 #include "NodeBuilder.h"
+#include "MeshOptimizer.h"
+#include "Instancing.h"
+#include "PointCloud.h"
+#include "TextureCache.h"
 #include "Log.h"
 
 #include <glm/gtc/type_ptr.hpp>
 
 #include <CesiumGltfContent/GltfUtilities.h>
 #include <CesiumGltf/AccessorView.h>
+#include <CesiumGltf/ExtensionExtMeshGpuInstancing.h>
+#include <CesiumGltf/ImageAsset.h>
+#include <CesiumUtility/IntrusivePointer.h>
 
 #include <osg/Geode>
 #include <osg/Texture2D>
 #include <osg/Geometry>
 #include <osg/Notify>
 #include <osg/MatrixTransform>
+#include <osg/NodeVisitor>
 #include <osg/Material>
 #include <osg/StateAttribute>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace czmosg
 {
@@ -118,6 +130,63 @@ namespace czmosg
         return material;
     }
 
+    /**
+     * @brief 直接引用 ImageAsset 像素内存的 osg::Image
+     * 持有 ImageAsset 的引用计数，像素数据不再复制一份；图像销毁时才释放对 ImageAsset 的引用。
+     */
+    class ImageAssetImage : public osg::Image
+    {
+    public:
+        explicit ImageAssetImage(const CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset>& asset)
+            : m_asset(asset)
+        {
+        }
+
+    protected:
+        // 基类析构时 NO_DELETE 模式不会释放像素内存，由 m_asset 负责
+        virtual ~ImageAssetImage() = default;
+
+    private:
+        CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset> m_asset;
+    };
+
+    // 按 2 的幂次缩小 8 位图像，直到宽高都不超过 maximumSize，每个输出像素取对应像素块的平均值
+    static osg::Image* downscaleImage(const CesiumGltf::ImageAsset& imageAsset, unsigned int maximumSize, GLint internalFormat, GLenum pixelFormat) {
+        const int channels = imageAsset.channels;
+        int factor = 1;
+        while (static_cast<unsigned int>(imageAsset.width / factor) > maximumSize ||
+            static_cast<unsigned int>(imageAsset.height / factor) > maximumSize) {
+            factor *= 2;
+        }
+        const int width = std::max(1, imageAsset.width / factor);
+        const int height = std::max(1, imageAsset.height / factor);
+
+        const unsigned char* source = reinterpret_cast<const unsigned char*>(imageAsset.pixelData.data());
+        unsigned char* pixels = new unsigned char[size_t(width) * height * channels];
+        for (int y = 0; y < height; ++y) {
+            // 宽高比悬殊时较短的一边不足 factor 个像素，像素块按图像边界截断
+            const int sampleRows = std::min(factor, imageAsset.height - y * factor);
+            for (int x = 0; x < width; ++x) {
+                const int sampleColumns = std::min(factor, imageAsset.width - x * factor);
+                const unsigned int samples = static_cast<unsigned int>(sampleRows * sampleColumns);
+                for (int c = 0; c < channels; ++c) {
+                    unsigned int sum = 0;
+                    for (int sy = 0; sy < sampleRows; ++sy) {
+                        const unsigned char* row = source + (size_t(y * factor + sy) * imageAsset.width + size_t(x) * factor) * channels;
+                        for (int sx = 0; sx < sampleColumns; ++sx) {
+                            sum += row[sx * channels + c];
+                        }
+                    }
+                    pixels[(size_t(y) * width + x) * channels + c] = static_cast<unsigned char>(sum / samples);
+                }
+            }
+        }
+
+        osg::Image* osgImage = new osg::Image;
+        osgImage->setImage(width, height, 1, internalFormat, pixelFormat, GL_UNSIGNED_BYTE, pixels, osg::Image::USE_NEW_DELETE);
+        return osgImage;
+    }
+
 	// 将glTF AccessorView转换为OSG数组的模板函数
 	template<typename T>
 	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<T>& accessorView) {
@@ -164,11 +233,175 @@ namespace czmosg
 		return result;
 	}
 
+	// glTF sampler 的环绕模式转换为 OSG 枚举
+	inline osg::Texture::WrapMode toOSGWrapMode(int32_t wrap) {
+		switch (wrap) {
+		case CesiumGltf::Sampler::WrapS::CLAMP_TO_EDGE:
+			return osg::Texture::CLAMP_TO_EDGE;
+		case CesiumGltf::Sampler::WrapS::MIRRORED_REPEAT:
+			return osg::Texture::MIRROR;
+		default:
+			return osg::Texture::REPEAT;
+		}
+	}
+
+	// glTF sampler 的过滤模式转换为 OSG 枚举
+	inline osg::Texture::FilterMode toOSGFilterMode(int32_t filter) {
+		switch (filter) {
+		case CesiumGltf::Sampler::MinFilter::NEAREST:
+			return osg::Texture::NEAREST;
+		case CesiumGltf::Sampler::MinFilter::LINEAR:
+			return osg::Texture::LINEAR;
+		case CesiumGltf::Sampler::MinFilter::NEAREST_MIPMAP_NEAREST:
+			return osg::Texture::NEAREST_MIPMAP_NEAREST;
+		case CesiumGltf::Sampler::MinFilter::LINEAR_MIPMAP_NEAREST:
+			return osg::Texture::LINEAR_MIPMAP_NEAREST;
+		case CesiumGltf::Sampler::MinFilter::NEAREST_MIPMAP_LINEAR:
+			return osg::Texture::NEAREST_MIPMAP_LINEAR;
+		default:
+			return osg::Texture::LINEAR_MIPMAP_LINEAR;
+		}
+	}
+
+	// 将 glTF 访问器按原始分量类型复制为 OSG 数组（不转换为 float），用于点云的紧凑属性；
+	// bound 非空时同时计算（反量化后的）包围盒
+	template<typename ArrayT, typename AccessorT>
+	osg::ref_ptr<ArrayT> accessorToCompactArray(const CesiumGltf::Model& model, const CesiumGltf::Accessor& accessor,
+		unsigned int components, osg::BoundingBox* bound = nullptr) {
+		CesiumGltf::AccessorView<AccessorT> view(model, accessor);
+		if (view.status() != CesiumGltf::AccessorViewStatus::Valid) {
+			return nullptr;
+		}
+
+		using ComponentT = std::remove_cv_t<std::remove_reference_t<decltype(view[0].value[0])>>;
+		const float scale = (accessor.normalized && std::is_integral_v<ComponentT>)
+			? 1.0f / static_cast<float>(std::numeric_limits<ComponentT>::max()) : 1.0f;
+
+		osg::ref_ptr<ArrayT> array = new ArrayT(static_cast<unsigned int>(view.size()));
+		for (int64_t i = 0; i < view.size(); ++i) {
+			const auto& value = view[i].value;
+			auto& element = (*array)[static_cast<unsigned int>(i)];
+			for (unsigned int c = 0; c < components; ++c) {
+				element[c] = value[c];
+			}
+			if (bound) {
+				bound->expandBy(value[0] * scale, value[1] * scale, value[2] * scale);
+			}
+		}
+		array->setNormalize(accessor.normalized);
+		return array;
+	}
+
+	// 将 glTF 标量索引访问器按原始分量类型（8/16/32 位）复制为 DrawElements
+	template<typename DrawElementsT, typename IndexT>
+	osg::ref_ptr<osg::DrawElements> accessorToDrawElements(const CesiumGltf::Model& model, const CesiumGltf::Accessor& accessor, GLenum mode) {
+		CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<IndexT>> view(model, accessor);
+		if (view.status() != CesiumGltf::AccessorViewStatus::Valid) {
+			return nullptr;
+		}
+
+		osg::ref_ptr<DrawElementsT> drawElements = new DrawElementsT(mode, static_cast<unsigned int>(view.size()));
+		for (int64_t i = 0; i < view.size(); ++i) {
+			(*drawElements)[static_cast<unsigned int>(i)] = view[i].value[0];
+		}
+		return drawElements;
+	}
+
+	// 统计子图中的节点数（包括 Drawable）
+	class NodeCountVisitor : public osg::NodeVisitor
+	{
+	public:
+		NodeCountVisitor() : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN) {}
+
+		void apply(osg::Node& node) override
+		{
+			++count;
+			traverse(node);
+		}
+
+		unsigned int count = 0;
+	};
+
+	// 收集子图中的几何体及其相对于子图根的累积变换，Geode 上的 StateSet 下移到几何体上
+	class FlattenCollectVisitor : public osg::NodeVisitor
+	{
+	public:
+		struct Item
+		{
+			osg::ref_ptr<osg::Geometry> geometry;
+			osg::Matrixd matrix;
+			// 几何体自身已有 StateSet、无法接收 Geode 的 StateSet 时保留后者
+			osg::ref_ptr<osg::StateSet> geodeStateSet;
+		};
+
+		FlattenCollectVisitor() : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+		{
+			m_matrixStack.push_back(osg::Matrixd::identity());
+		}
+
+		void apply(osg::Transform& transform) override
+		{
+			osg::Matrixd matrix = m_matrixStack.back();
+			transform.computeLocalToWorldMatrix(matrix, this);
+			m_matrixStack.push_back(matrix);
+			traverse(transform);
+			m_matrixStack.pop_back();
+		}
+
+		void apply(osg::Geode& geode) override
+		{
+			for (unsigned int i = 0; i < geode.getNumDrawables(); ++i) {
+				osg::Geometry* geometry = geode.getDrawable(i)->asGeometry();
+				if (!geometry) {
+					continue;
+				}
+
+				osg::StateSet* geodeStateSet = geode.getStateSet();
+				if (geodeStateSet && !geometry->getStateSet()) {
+					geometry->setStateSet(geodeStateSet);
+					geodeStateSet = nullptr;
+				}
+
+				// 同一几何体被多个节点引用时，在变换之前复制一份
+				if (!m_collected.insert(geometry).second) {
+					geometry = new osg::Geometry(*geometry, osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES);
+				}
+				items.push_back({ geometry, m_matrixStack.back(), geodeStateSet });
+			}
+		}
+
+		std::vector<Item> items;
+
+	private:
+		std::vector<osg::Matrixd> m_matrixStack;
+		std::set<osg::Geometry*> m_collected;
+	};
+
+	void SharedStateBindings::bind()
+	{
+		for (auto& [stateSet, texture] : textures) {
+			stateSet->setTextureAttributeAndModes(0, texture.get());
+		}
+		textures.clear();
+
+		for (auto& [placeholder, sharedStateSet] : stateSets) {
+			osg::StateSet::ParentList parents = placeholder->getParents();
+			for (osg::Node* parent : parents) {
+				parent->setStateSet(sharedStateSet.get());
+			}
+		}
+		stateSets.clear();
+	}
+
 	NodeBuilder::NodeBuilder(CesiumGltf::Model* model, const glm::dmat4& transform)
 		: m_model(model), m_transform(transform)
 	{
 	}
 
+	NodeBuilder::~NodeBuilder()
+	{
+	}
+
 	osg::Node* NodeBuilder::build() {
         osg::MatrixTransform* root = new osg::MatrixTransform;
         osg::Matrixd matrix;
@@ -229,10 +462,20 @@ namespace czmosg
             }
         }
 
+        // 可选：将静态变换预乘进几何体，把整棵子树压平为一个 Geode
+        m_statistics.sceneNodesBeforeFlatten = countNodes(root);
+        if (m_flattenHierarchy) {
+            flattenHierarchy(root);
+        }
+        m_statistics.sceneNodes = countNodes(root);
+
         osg::Group* container = new osg::Group;
         container->addChild(root);
         
         CO_INFO("Built scene with {} nodes", nodeCount);
+
+        // 已由缩小的副本或共享纹理替代的图像不再需要原像素数据
+        releaseReplacedImages();
         
         // 强制更新边界
         container->dirtyBound();
@@ -307,9 +550,8 @@ namespace czmosg
 					translation.makeIdentity(); // 默认无平移
 				}
 
-				// root->setMatrix(rotation * scale * translation);
-				// 应用变换顺序：平移 * 旋转 * 缩放
-				root->setMatrix(translation * rotation * scale);
+				// glTF 的 T * R * S 在 OSG 行向量约定下写作 S * R * T
+				root->setMatrix(scale * rotation * translation);
 			}
 		}
 
@@ -317,6 +559,20 @@ namespace czmosg
         if (node.mesh >= 0 && node.mesh < m_model->meshes.size()) {
             osg::Node* meshNode = createMesh(m_model->meshes[node.mesh]);
             if (meshNode) {
+                // EXT_mesh_gpu_instancing（i3dm 由 cesium-native 转换为该扩展）：每个网格一次实例化绘制
+                const auto* instancing = node.getExtension<CesiumGltf::ExtensionExtMeshGpuInstancing>();
+                if (instancing) {
+                    std::vector<osg::Matrixd> instances = readInstanceTransforms(*instancing);
+                    if (!instances.empty()) {
+                        // 全局共享的实例化 StateSet 在主线程中才挂接，这里先使用占位的 StateSet
+                        if (!m_instancingStateSets.textured.valid()) {
+                            m_instancingStateSets.textured = createPlaceholderStateSet(getInstancingStateSet(true));
+                            m_instancingStateSets.untextured = createPlaceholderStateSet(getInstancingStateSet(false));
+                        }
+                        m_statistics.instancedGeometries += setupInstancedNode(meshNode, instances, m_instancingStateSets);
+                        m_statistics.instances += static_cast<unsigned int>(instances.size());
+                    }
+                }
                 root->addChild(meshNode);
             }
         }
@@ -337,6 +593,17 @@ namespace czmosg
         CO_TRACE("Creating mesh with {} primitives", mesh.primitives.size());
 
         for (size_t primIndex = 0; primIndex < mesh.primitives.size(); primIndex++) {
+            // 点云（pnts 由 cesium-native 转换为 POINTS 图元）走紧凑属性 + 着色器的单独路径
+            if (mesh.primitives[primIndex].mode == CesiumGltf::MeshPrimitive::Mode::POINTS) {
+                osg::ref_ptr<osg::Geometry> points = createPointCloud(mesh.primitives[primIndex]);
+                if (points.valid()) {
+                    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+                    geode->addDrawable(points);
+                    group->addChild(geode);
+                }
+                continue;
+            }
+
             osg::ref_ptr<osg::Geode> geode = new osg::Geode;
             osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
 
@@ -348,6 +615,8 @@ namespace czmosg
             int vertexCount = 0;
             osg::Vec3Array* vertices = nullptr;
             const auto& primitive = mesh.primitives[primIndex];
+            // glTF 的图元模式取值与 GL 枚举一致
+            const GLenum mode = static_cast<GLenum>(primitive.mode);
 
             for (const auto& attribute : primitive.attributes) {
                 const std::string& attributeName = attribute.first;
@@ -404,31 +673,28 @@ namespace czmosg
                 if (indexAccessor.componentType == CesiumGltf::Accessor::ComponentType::UNSIGNED_SHORT) {
                     auto indexView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint16_t>>(*m_model, indexAccessor);
                     if (indexView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-                        osg::UShortArray* indices = static_cast<osg::UShortArray*>(accessorViewToArray(indexView));
-                        if (indices) {
-                            osg::DrawElementsUShort* drawElements = new osg::DrawElementsUShort(osg::PrimitiveSet::TRIANGLES);
-                            for (size_t i = 0; i < indices->size(); ++i) {
-                                drawElements->push_back((*indices)[i]);
-                            }
-                            geometry->addPrimitiveSet(drawElements);
-                            hasIndices = true;
-                            CO_TRACE("Added {} unsigned short indices", indices->size());
+                        // 直接按索引数分配 DrawElements，不经过中间数组和逐个 push_back 的扩容
+                        const unsigned int indexCount = static_cast<unsigned int>(indexView.size());
+                        osg::DrawElementsUShort* drawElements = new osg::DrawElementsUShort(mode, indexCount);
+                        for (unsigned int i = 0; i < indexCount; ++i) {
+                            (*drawElements)[i] = indexView[i].value[0];
                         }
+                        geometry->addPrimitiveSet(drawElements);
+                        hasIndices = true;
+                        CO_TRACE("Added {} unsigned short indices", indexCount);
                     }
                 }
                 else if (indexAccessor.componentType == CesiumGltf::Accessor::ComponentType::UNSIGNED_INT) {
                     auto indexView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint32_t>>(*m_model, indexAccessor);
                     if (indexView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-                        osg::UIntArray* indices = static_cast<osg::UIntArray*>(accessorViewToArray(indexView));
-                        if (indices) {
-                            osg::DrawElementsUInt* drawElements = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES);
-                            for (size_t i = 0; i < indices->size(); ++i) {
-                                drawElements->push_back((*indices)[i]);
-                            }
-                            geometry->addPrimitiveSet(drawElements);
-                            hasIndices = true;
-                            CO_TRACE("Added {} unsigned int indices", indices->size());
+                        const unsigned int indexCount = static_cast<unsigned int>(indexView.size());
+                        osg::DrawElementsUInt* drawElements = new osg::DrawElementsUInt(mode, indexCount);
+                        for (unsigned int i = 0; i < indexCount; ++i) {
+                            (*drawElements)[i] = indexView[i].value[0];
                         }
+                        geometry->addPrimitiveSet(drawElements);
+                        hasIndices = true;
+                        CO_TRACE("Added {} unsigned int indices", indexCount);
                     }
                 }
             }
@@ -437,7 +703,7 @@ namespace czmosg
             if (!hasIndices) {
                 if (geometry->getVertexArray() && geometry->getVertexArray()->getNumElements() > 0) {
                     int numVertices = geometry->getVertexArray()->getNumElements();
-                    geometry->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, numVertices));
+                    geometry->addPrimitiveSet(new osg::DrawArrays(mode, 0, numVertices));
                     CO_TRACE("Using vertex array with {} vertices", numVertices);
                 } else {
                     CO_WARN("No valid vertex data for primitive");
@@ -445,23 +711,10 @@ namespace czmosg
                 }
             }
 
-            // 处理材质和纹理
-            //osg::ref_ptr<osg::StateSet> stateSet = geometry->getOrCreateStateSet();
-            osg::ref_ptr<osg::StateSet> stateSet = geode->getOrCreateStateSet();
-            stateSet->setMode(GL_CULL_FACE, osg::StateAttribute::ON);
-
-            // 确保 geometry 没有自己的 StateSet
-            if (geometry->getStateSet()) {
-                CO_WARN("Geometry has its own StateSet! This may override Geode's material.");
-            }
-            
-            // 启用光照
-            stateSet->setMode(GL_LIGHTING, osg::StateAttribute::ON);
-            stateSet->setMode(GL_DEPTH_TEST, osg::StateAttribute::ON);
+            // 处理材质和纹理：先确定材质内容键，相同内容的图元共享同一个 StateSet
+            StateSetKey stateSetKey;
 
             // 检查primitive是否有材质
-            bool hasValidMaterial = false;
-			bool hasValidTexture = false;
             if (primitive.material >= 0 && primitive.material < m_model->materials.size()) {
                 const auto& material = m_model->materials[primitive.material];
                 CO_TRACE("Processing material {}", primitive.material);
@@ -509,24 +762,17 @@ namespace czmosg
                     //    CO_WARN("Invalid baseColorFactor size: {}", pbr.baseColorFactor.size());
                     //}
 
-                    // 基础颜色（Gamma 校正）
-                    osg::Vec4 baseColor(0.8f, 0.8f, 0.8f, 1.0f);
+                    // 基础颜色（Gamma 校正在创建材质时进行；瓦片直接使用线性值）
                     if (baseColorFactor.size() >= 4) {
-                        baseColor.set(
+                        stateSetKey.material.kind = m_tileRenderState ? MaterialKey::BASE_COLOR : MaterialKey::PBR;
+                        stateSetKey.material.baseColor.set(
                             baseColorFactor[0],
                             baseColorFactor[1],
                             baseColorFactor[2],
                             baseColorFactor[3]
                         );
-
-						// 从 PBR 参数创建 OSG 材质（含 Gamma 校正）
-                        osg::ref_ptr<osg::Material> osgMaterial = createOSGMaterialFromPBR(
-                            baseColor, metallicFactor, roughnessFactor
-                        );
-
-                        // 设置材质
-                        stateSet->setAttributeAndModes(osgMaterial/*, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE */);
-                        hasValidMaterial = true;
+                        stateSetKey.material.metallic = metallicFactor;
+                        stateSetKey.material.roughness = roughnessFactor;
                     } else {
                         CO_WARN("Invalid baseColorFactor size: {}", pbr.baseColorFactor.size());
                     }
@@ -535,81 +781,33 @@ namespace czmosg
                     if (pbr.baseColorTexture && pbr.baseColorTexture->index >= 0 &&
                         pbr.baseColorTexture->index < m_model->textures.size())
                     {
-                        const auto& texture = m_model->textures[pbr.baseColorTexture->index];
                         CO_TRACE("Loading base color texture {}", pbr.baseColorTexture->index);
-
-                        if (texture.source >= 0 && texture.source < m_model->images.size())
-                        {
-                            const auto& image = m_model->images[texture.source];
-
-                            // 检查图像资产是否存在
-                            if (image.pAsset && !image.pAsset->pixelData.empty())
-                            {
-                                const auto& imageAsset = *image.pAsset;
-                                CO_TRACE("Image source {} , data size: {}", texture.source, imageAsset.pixelData.size());
-
-                                osg::Texture2D* osgTexture = new osg::Texture2D;
-
-                                // 创建OSG图像
-                                osg::Image* osgImage = new osg::Image;
-
-                                // 确定图像格式
-                                GLenum pixelFormat = GL_RGB;
-                                GLenum dataType = GL_UNSIGNED_BYTE;
-                                GLint internalFormat = GL_RGB8;
-
-                                if (imageAsset.channels == 4) {
-                                    pixelFormat = GL_RGBA;
-                                    internalFormat = GL_RGBA8;
-                                }
-                                else if (imageAsset.channels == 3) {
-                                    pixelFormat = GL_RGB;
-                                    internalFormat = GL_RGB8;
-                                }
-                                CO_TRACE("Image format: {}x{}, channels: {}", imageAsset.width, imageAsset.height, imageAsset.channels);
-
-                                // 复制像素数据
-                                unsigned char* imageData = new unsigned char[imageAsset.pixelData.size()];
-                                std::memcpy(imageData, imageAsset.pixelData.data(), imageAsset.pixelData.size());
-
-                                osgImage->setImage(
-                                    imageAsset.width,
-                                    imageAsset.height,
-                                    1, // depth
-                                    internalFormat,
-                                    pixelFormat,
-                                    dataType,
-                                    imageData,
-                                    osg::Image::USE_NEW_DELETE
-                                );
-
-                                osgTexture->setImage(osgImage);
-                                osgTexture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::REPEAT);
-                                osgTexture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::REPEAT);
-                                osgTexture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR_MIPMAP_LINEAR);
-                                osgTexture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::LINEAR);
-
-                                stateSet->setTextureAttributeAndModes(0, osgTexture/*, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE*/);
-                                //stateSet->setTextureMode(0, GL_TEXTURE_2D, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
-                                hasValidTexture = true;
-                                CO_TRACE("Texture applied successfully");
-                            }
-                        }
+                        stateSetKey.texture = createTexture(pbr.baseColorTexture->index);
                     }
                 }
+
+                // 单面材质开启背面剔除，双面材质（如开放的倾斜摄影外壳）保留背面
+                stateSetKey.cullFace = !material.doubleSided;
 			}
-            
-            if (!hasValidMaterial && !hasValidTexture) {
-                CO_WARN("No valid material found for primitive {}, using default white material");
-                // 设置默认材质
-                osg::Material* defaultMaterial = new osg::Material;
-                defaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.8f, 0.8f, 0.8f, 1.0f));
-                defaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.3f, 0.3f, 0.3f, 1.0f));
-                defaultMaterial->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.1f, 0.1f, 0.1f, 1.0f));
-                defaultMaterial->setShininess(osg::Material::FRONT_AND_BACK, 32.0f);
-                stateSet->setAttributeAndModes(defaultMaterial, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
+            else {
+                // 没有材质的图元：独立模型保持背面剔除，瓦片与原瓦片路径一致不剔除
+                stateSetKey.cullFace = !m_tileRenderState;
             }
 
+            if (m_tileRenderState) {
+                // 瓦片只在图元没有材质时使用白色默认材质
+                if (primitive.material < 0 || primitive.material >= m_model->materials.size()) {
+                    CO_WARN("No valid material found for primitive {}, using default white material", primIndex);
+                    stateSetKey.material.kind = MaterialKey::DEFAULT_WHITE;
+                }
+            }
+            else if (stateSetKey.material.kind == MaterialKey::NONE && !stateSetKey.texture) {
+                CO_WARN("No valid material found for primitive {}, using default white material", primIndex);
+                stateSetKey.material.kind = MaterialKey::DEFAULT;
+            }
+
+            geode->setStateSet(getOrCreateStateSet(stateSetKey));
+
             geode->addDrawable(geometry);
             group->addChild(geode);
         }
@@ -623,4 +821,523 @@ namespace czmosg
         return group;
     }
 
-}	// namespace czmosg
\ No newline at end of file
+    osg::Texture2D* NodeBuilder::createTexture(int32_t textureIndex) {
+        if (textureIndex < 0 || textureIndex >= m_model->textures.size()) {
+            return nullptr;
+        }
+
+        const CesiumGltf::Texture& texture = m_model->textures[textureIndex];
+        if (texture.source < 0 || texture.source >= m_model->images.size()) {
+            return nullptr;
+        }
+
+        // 同一图像 + 同一采样器只创建一个纹理
+        const std::pair<int32_t, int32_t> textureKey(texture.source, texture.sampler);
+        auto itr = m_textures.find(textureKey);
+        if (itr != m_textures.end()) {
+            if (itr->second.valid()) {
+                const osg::Image* image = itr->second->getImage();
+                m_statistics.texturesShared++;
+                m_statistics.textureBytesSaved += image ? image->getTotalSizeInBytes() : 0;
+            }
+            return itr->second.get();
+        }
+
+        TextureSamplerState samplerState;
+        if (texture.sampler >= 0 && texture.sampler < m_model->samplers.size()) {
+            const CesiumGltf::Sampler& sampler = m_model->samplers[texture.sampler];
+            samplerState.wrapS = toOSGWrapMode(sampler.wrapS);
+            samplerState.wrapT = toOSGWrapMode(sampler.wrapT);
+            if (sampler.minFilter) {
+                samplerState.minFilter = toOSGFilterMode(*sampler.minFilter);
+            }
+            if (sampler.magFilter && *sampler.magFilter == CesiumGltf::Sampler::MagFilter::NEAREST) {
+                samplerState.magFilter = osg::Texture::NEAREST;
+            }
+        }
+
+        // 跨瓦片缓存：按像素内容查找已存在的相同纹理
+        TextureCacheKey cacheKey;
+        const CesiumGltf::Image& image = m_model->images[texture.source];
+        // 需要缩小的图像不进入缓存：缓存键和命中校验都基于原始像素，缩小后的纹理不能与全分辨率纹理互相替代
+        const bool cacheable = m_textureCache && image.pAsset && !image.pAsset->pixelData.empty() &&
+            !shouldDownscale(*image.pAsset);
+        if (cacheable) {
+            cacheKey = TextureCacheKey::create(*image.pAsset, samplerState);
+            osg::ref_ptr<osg::Texture2D> sharedTexture = m_textureCache->find(cacheKey, image.pAsset->pixelData);
+            if (sharedTexture.valid()) {
+                m_statistics.texturesSharedAcrossTiles++;
+                m_statistics.textureBytesSaved += image.pAsset->pixelData.size();
+                // 已由共享纹理替代，本模型中的像素数据不再需要
+                m_replacedImages.insert(texture.source);
+                m_sharedResources.insert(sharedTexture.get());
+                m_sharedResources.insert(sharedTexture->getImage());
+                m_cachedTextures.insert(sharedTexture.get());
+                m_textures[textureKey] = sharedTexture;
+                return sharedTexture.get();
+            }
+        }
+
+        osg::Image* osgImage = createImage(texture.source);
+        if (!osgImage) {
+            m_textures[textureKey] = nullptr;
+            return nullptr;
+        }
+
+        osg::ref_ptr<osg::Texture2D> osgTexture = new osg::Texture2D;
+        osgTexture->setImage(osgImage);
+        osgTexture->setWrap(osg::Texture2D::WRAP_S, samplerState.wrapS);
+        osgTexture->setWrap(osg::Texture2D::WRAP_T, samplerState.wrapT);
+        osgTexture->setFilter(osg::Texture2D::MIN_FILTER, samplerState.minFilter);
+        osgTexture->setFilter(osg::Texture2D::MAG_FILTER, samplerState.magFilter);
+        m_statistics.texturesCreated++;
+
+        if (cacheable) {
+            // 登记后其它瓦片即可取得该纹理，本瓦片也改在主线程中挂接
+            m_textureCache->insert(cacheKey, osgTexture.get());
+            m_cachedTextures.insert(osgTexture.get());
+        }
+
+        m_textures[textureKey] = osgTexture;
+        return osgTexture.get();
+    }
+
+    bool NodeBuilder::shouldDownscale(const CesiumGltf::ImageAsset& imageAsset) const {
+        const bool oversized = m_maximumTextureSize > 0 &&
+            (static_cast<unsigned int>(imageAsset.width) > m_maximumTextureSize ||
+                static_cast<unsigned int>(imageAsset.height) > m_maximumTextureSize);
+        return oversized && imageAsset.bytesPerChannel == 1 && (imageAsset.channels == 3 || imageAsset.channels == 4) &&
+            imageAsset.pixelData.size() >= size_t(imageAsset.width) * imageAsset.height * imageAsset.channels;
+    }
+
+    osg::Image* NodeBuilder::createImage(int32_t imageIndex) {
+        if (imageIndex < 0 || imageIndex >= m_model->images.size()) {
+            return nullptr;
+        }
+
+        // 多个纹理（不同采样器）引用同一图像时共享一个 osg::Image
+        auto itr = m_images.find(imageIndex);
+        if (itr != m_images.end()) {
+            return itr->second.get();
+        }
+
+        const CesiumGltf::Image& image = m_model->images[imageIndex];
+
+        // 检查图像资产是否存在
+        if (!image.pAsset || image.pAsset->pixelData.empty()) {
+            return nullptr;
+        }
+
+        CesiumGltf::ImageAsset& imageAsset = *image.pAsset;
+        CO_TRACE("Image source {} , data size: {}", imageIndex, imageAsset.pixelData.size());
+
+        // 确定图像格式
+        GLenum pixelFormat = GL_RGB;
+        GLenum dataType = GL_UNSIGNED_BYTE;
+        GLint internalFormat = GL_RGB8;
+
+        if (imageAsset.channels == 4) {
+            pixelFormat = GL_RGBA;
+            internalFormat = GL_RGBA8;
+        }
+        else if (imageAsset.channels == 3) {
+            pixelFormat = GL_RGB;
+            internalFormat = GL_RGB8;
+        }
+        CO_TRACE("Image format: {}x{}, channels: {}", imageAsset.width, imageAsset.height, imageAsset.channels);
+
+        // 超过纹理尺寸上限（内存紧张）时缩小后复制，原图像资产随模型数据一起释放
+        if (shouldDownscale(imageAsset)) {
+            osg::Image* osgImage = downscaleImage(imageAsset, m_maximumTextureSize, internalFormat, pixelFormat);
+            CO_TRACE("Downscaled image {} from {}x{} to {}x{}", imageIndex, imageAsset.width, imageAsset.height, osgImage->s(), osgImage->t());
+            m_statistics.texturesDownscaled++;
+            m_images[imageIndex] = osgImage;
+            m_replacedImages.insert(imageIndex);
+            return osgImage;
+        }
+
+        // 直接引用解码后的像素内存，生命周期由 ImageAssetImage 持有的引用保证；
+        // 模型中的引用保留（不占额外内存），cesium-native 按模型统计的缓存大小仍包含这部分像素
+        osg::Image* osgImage = new ImageAssetImage(image.pAsset);
+        osgImage->setImage(
+            imageAsset.width,
+            imageAsset.height,
+            1, // depth
+            internalFormat,
+            pixelFormat,
+            dataType,
+            reinterpret_cast<unsigned char*>(imageAsset.pixelData.data()),
+            osg::Image::NO_DELETE
+        );
+
+        m_images[imageIndex] = osgImage;
+        m_modelImages.insert(osgImage);
+        return osgImage;
+    }
+
+    void NodeBuilder::releaseReplacedImages() {
+        for (int32_t imageIndex : m_replacedImages) {
+            m_model->images[imageIndex].pAsset = CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset>();
+        }
+
+        if (!m_replacedImages.empty()) {
+            CO_DEBUG("Released {} image assets replaced by downscaled or shared textures", m_replacedImages.size());
+        }
+        m_replacedImages.clear();
+    }
+
+    osg::StateSet* NodeBuilder::createPlaceholderStateSet(osg::StateSet* sharedStateSet) {
+        osg::ref_ptr<osg::StateSet> placeholder = new osg::StateSet;
+        m_sharedStateBindings.stateSets.emplace_back(placeholder, sharedStateSet);
+        // 占位与共享的 StateSet 都不归本瓦片所有，内存统计时排除
+        m_sharedResources.insert(placeholder.get());
+        m_sharedResources.insert(sharedStateSet);
+        return placeholder.get();
+    }
+
+    osg::StateSet* NodeBuilder::getOrCreateStateSet(const StateSetKey& key) {
+        auto itr = m_stateSets.find(key);
+        if (itr != m_stateSets.end()) {
+            return itr->second.get();
+        }
+
+        osg::ref_ptr<osg::StateSet> stateSet = new osg::StateSet;
+        if (key.cullFace) {
+            stateSet->setMode(GL_CULL_FACE, osg::StateAttribute::ON);
+        }
+
+        // 启用光照（瓦片沿用场景的光照和深度测试设置）
+        if (!m_tileRenderState) {
+            stateSet->setMode(GL_LIGHTING, osg::StateAttribute::ON);
+            stateSet->setMode(GL_DEPTH_TEST, osg::StateAttribute::ON);
+        }
+
+        if (key.material.kind != MaterialKey::NONE) {
+            // 默认材质需要覆盖下层状态，保持原有行为
+            osg::StateAttribute::GLModeValue value = osg::StateAttribute::ON;
+            if (key.material.kind == MaterialKey::DEFAULT) {
+                value |= osg::StateAttribute::OVERRIDE;
+            }
+            stateSet->setAttributeAndModes(getOrCreateMaterial(key.material), value);
+        }
+
+        if (key.texture) {
+            if (m_cachedTextures.count(key.texture)) {
+                // 缓存中的纹理可能正被其它瓦片绘制，只打开纹理模式，纹理由主线程挂接
+                stateSet->setTextureMode(0, GL_TEXTURE_2D, osg::StateAttribute::ON);
+                m_sharedStateBindings.textures.emplace_back(stateSet, key.texture);
+            }
+            else {
+                stateSet->setTextureAttributeAndModes(0, key.texture/*, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE*/);
+            }
+            CO_TRACE("Texture applied successfully");
+        }
+
+        m_stateSets[key] = stateSet;
+        return stateSet.get();
+    }
+
+    osg::Material* NodeBuilder::getOrCreateMaterial(const MaterialKey& key) {
+        auto itr = m_materials.find(key);
+        if (itr != m_materials.end()) {
+            return itr->second.get();
+        }
+
+        osg::ref_ptr<osg::Material> material;
+        if (key.kind == MaterialKey::PBR) {
+            // 从 PBR 参数创建 OSG 材质（含 Gamma 校正）
+            material = createOSGMaterialFromPBR(key.baseColor, key.metallic, key.roughness);
+        }
+        else if (key.kind == MaterialKey::BASE_COLOR) {
+            material = new osg::Material;
+            material->setDiffuse(osg::Material::FRONT_AND_BACK, key.baseColor);
+            material->setAmbient(osg::Material::FRONT_AND_BACK, key.baseColor * 0.2f);
+        }
+        else if (key.kind == MaterialKey::DEFAULT_WHITE) {
+            material = new osg::Material;
+            material->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+            material->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0f));
+        }
+        else {
+            // 设置默认材质
+            material = new osg::Material;
+            material->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.8f, 0.8f, 0.8f, 1.0f));
+            material->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.3f, 0.3f, 0.3f, 1.0f));
+            material->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(0.1f, 0.1f, 0.1f, 1.0f));
+            material->setShininess(osg::Material::FRONT_AND_BACK, 32.0f);
+        }
+
+        m_materials[key] = material;
+        return material.get();
+    }
+
+    unsigned int NodeBuilder::countNodes(osg::Node* node) const {
+        NodeCountVisitor visitor;
+        node->accept(visitor);
+        return visitor.count;
+    }
+
+    osg::Geometry* NodeBuilder::createPointCloud(const CesiumGltf::MeshPrimitive& primitive) {
+        using namespace CesiumGltf;
+
+        auto positionItr = primitive.attributes.find("POSITION");
+        if (positionItr == primitive.attributes.end() || positionItr->second < 0 || positionItr->second >= m_model->accessors.size()) {
+            CO_WARN("Point primitive has no valid POSITION attribute");
+            return nullptr;
+        }
+        const Accessor& positionAccessor = m_model->accessors[positionItr->second];
+
+        // 量化的位置（KHR_mesh_quantization）保持 short/byte 存储，反量化由节点变换和归一化完成
+        osg::ref_ptr<osg::Array> positions;
+        osg::BoundingBox bound;
+        switch (positionAccessor.componentType) {
+        case Accessor::ComponentType::FLOAT:
+            positions = accessorToCompactArray<osg::Vec3Array, AccessorTypes::VEC3<float>>(*m_model, positionAccessor, 3, &bound);
+            break;
+        case Accessor::ComponentType::UNSIGNED_SHORT:
+            positions = accessorToCompactArray<osg::Vec3usArray, AccessorTypes::VEC3<uint16_t>>(*m_model, positionAccessor, 3, &bound);
+            break;
+        case Accessor::ComponentType::SHORT:
+            positions = accessorToCompactArray<osg::Vec3sArray, AccessorTypes::VEC3<int16_t>>(*m_model, positionAccessor, 3, &bound);
+            break;
+        case Accessor::ComponentType::UNSIGNED_BYTE:
+            positions = accessorToCompactArray<osg::Vec3ubArray, AccessorTypes::VEC3<uint8_t>>(*m_model, positionAccessor, 3, &bound);
+            break;
+        case Accessor::ComponentType::BYTE:
+            positions = accessorToCompactArray<osg::Vec3bArray, AccessorTypes::VEC3<int8_t>>(*m_model, positionAccessor, 3, &bound);
+            break;
+        default:
+            break;
+        }
+        if (!positions.valid() || positions->getNumElements() == 0) {
+            CO_WARN("Unsupported point POSITION accessor (component type {})", positionAccessor.componentType);
+            return nullptr;
+        }
+
+        osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+        geometry->setUseDisplayList(false);
+        geometry->setUseVertexBufferObjects(true);
+        geometry->setVertexAttribArray(POINT_POSITION, positions.get(), osg::Array::BIND_PER_VERTEX);
+
+        // 颜色保持 RGB/RGBA8（或 16 位）存储，在着色器中归一化
+        osg::ref_ptr<osg::Array> colors;
+        auto colorItr = primitive.attributes.find("COLOR_0");
+        if (colorItr != primitive.attributes.end() && colorItr->second >= 0 && colorItr->second < m_model->accessors.size()) {
+            const Accessor& colorAccessor = m_model->accessors[colorItr->second];
+            const bool rgba = colorAccessor.type == Accessor::Type::VEC4;
+            switch (colorAccessor.componentType) {
+            case Accessor::ComponentType::UNSIGNED_BYTE:
+                colors = rgba
+                    ? osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec4ubArray, AccessorTypes::VEC4<uint8_t>>(*m_model, colorAccessor, 4))
+                    : osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec3ubArray, AccessorTypes::VEC3<uint8_t>>(*m_model, colorAccessor, 3));
+                break;
+            case Accessor::ComponentType::UNSIGNED_SHORT:
+                colors = rgba
+                    ? osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec4usArray, AccessorTypes::VEC4<uint16_t>>(*m_model, colorAccessor, 4))
+                    : osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec3usArray, AccessorTypes::VEC3<uint16_t>>(*m_model, colorAccessor, 3));
+                break;
+            case Accessor::ComponentType::FLOAT:
+                colors = rgba
+                    ? osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec4Array, AccessorTypes::VEC4<float>>(*m_model, colorAccessor, 4))
+                    : osg::ref_ptr<osg::Array>(accessorToCompactArray<osg::Vec3Array, AccessorTypes::VEC3<float>>(*m_model, colorAccessor, 3));
+                break;
+            default:
+                break;
+            }
+            if (colors.valid() && colors->getNumElements() != positions->getNumElements()) {
+                colors = nullptr;
+            }
+            if (!colors.valid()) {
+                CO_WARN("Unsupported point COLOR_0 accessor, using material color");
+            }
+        }
+
+        if (colors.valid()) {
+            geometry->setVertexAttribArray(POINT_COLOR, colors.get(), osg::Array::BIND_PER_VERTEX);
+        }
+        else {
+            // 没有逐点颜色时使用材质的基础颜色
+            osg::Vec4 color(1.0f, 1.0f, 1.0f, 1.0f);
+            if (primitive.material >= 0 && primitive.material < m_model->materials.size()) {
+                const auto& material = m_model->materials[primitive.material];
+                if (material.pbrMetallicRoughness && material.pbrMetallicRoughness->baseColorFactor.size() >= 4) {
+                    const auto& factor = material.pbrMetallicRoughness->baseColorFactor;
+                    color.set(factor[0], factor[1], factor[2], factor[3]);
+                }
+            }
+            geometry->setVertexAttribArray(POINT_COLOR, new osg::Vec4Array(1, &color), osg::Array::BIND_OVERALL);
+        }
+
+        const unsigned int pointCount = positions->getNumElements();
+        if (primitive.indices >= 0 && primitive.indices < m_model->accessors.size()) {
+            // 索引按访问器的分量类型读取，保持原有的 8/16/32 位存储
+            const Accessor& indexAccessor = m_model->accessors[primitive.indices];
+            osg::ref_ptr<osg::DrawElements> drawElements;
+            switch (indexAccessor.componentType) {
+            case Accessor::ComponentType::UNSIGNED_BYTE:
+                drawElements = accessorToDrawElements<osg::DrawElementsUByte, uint8_t>(*m_model, indexAccessor, GL_POINTS);
+                break;
+            case Accessor::ComponentType::UNSIGNED_SHORT:
+                drawElements = accessorToDrawElements<osg::DrawElementsUShort, uint16_t>(*m_model, indexAccessor, GL_POINTS);
+                break;
+            case Accessor::ComponentType::UNSIGNED_INT:
+                drawElements = accessorToDrawElements<osg::DrawElementsUInt, uint32_t>(*m_model, indexAccessor, GL_POINTS);
+                break;
+            default:
+                CO_WARN("Unsupported point index accessor (component type {})", indexAccessor.componentType);
+                break;
+            }
+            if (drawElements.valid()) {
+                geometry->addPrimitiveSet(drawElements.get());
+            }
+        }
+        if (geometry->getNumPrimitiveSets() == 0) {
+            geometry->addPrimitiveSet(new osg::DrawArrays(GL_POINTS, 0, pointCount));
+        }
+
+        // 位置不在顶点数组中，OSG 无法自动计算包围盒
+        geometry->setInitialBound(bound);
+
+        // 全局共享的点云 StateSet 在主线程中才挂接，这里先使用占位的 StateSet
+        if (!m_pointCloudStateSet.valid()) {
+            m_pointCloudStateSet = createPlaceholderStateSet(getPointCloudStateSet());
+        }
+        geometry->setStateSet(m_pointCloudStateSet.get());
+
+        m_statistics.pointPrimitives++;
+        m_statistics.points += pointCount;
+        CO_TRACE("Created point cloud with {} points", pointCount);
+        return geometry.release();
+    }
+
+    std::vector<osg::Matrixd> NodeBuilder::readInstanceTransforms(const CesiumGltf::ExtensionExtMeshGpuInstancing& instancing) const {
+        std::vector<osg::Matrixd> instances;
+
+        auto findAccessor = [&](const std::string& name) -> const CesiumGltf::Accessor* {
+            auto itr = instancing.attributes.find(name);
+            if (itr == instancing.attributes.end() || itr->second < 0 || itr->second >= m_model->accessors.size()) {
+                return nullptr;
+            }
+            return &m_model->accessors[itr->second];
+        };
+
+        const CesiumGltf::Accessor* translationAccessor = findAccessor("TRANSLATION");
+        const CesiumGltf::Accessor* rotationAccessor = findAccessor("ROTATION");
+        const CesiumGltf::Accessor* scaleAccessor = findAccessor("SCALE");
+
+        int64_t count = -1;
+        for (const CesiumGltf::Accessor* accessor : { translationAccessor, rotationAccessor, scaleAccessor }) {
+            if (accessor) {
+                if (count >= 0 && accessor->count != count) {
+                    CO_WARN("EXT_mesh_gpu_instancing attributes have different counts ({} vs {})", count, accessor->count);
+                    return instances;
+                }
+                count = accessor->count;
+            }
+        }
+        if (count <= 0) {
+            return instances;
+        }
+
+        instances.assign(static_cast<size_t>(count), osg::Matrixd::identity());
+
+        if (translationAccessor) {
+            CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC3<float>> view(*m_model, *translationAccessor);
+            if (view.status() != CesiumGltf::AccessorViewStatus::Valid) {
+                CO_WARN("Invalid instance TRANSLATION accessor: {}", static_cast<int>(view.status()));
+                return {};
+            }
+            for (int64_t i = 0; i < count; ++i) {
+                instances[i].postMultTranslate(osg::Vec3d(view[i].value[0], view[i].value[1], view[i].value[2]));
+            }
+        }
+
+        if (rotationAccessor) {
+            // 规范允许 float 以及归一化的 byte/short 四元数
+            std::vector<osg::Quat> rotations(static_cast<size_t>(count));
+            auto readRotations = [&](auto view, double scale) {
+                if (view.status() != CesiumGltf::AccessorViewStatus::Valid) {
+                    return false;
+                }
+                for (int64_t i = 0; i < count; ++i) {
+                    const auto& value = view[i].value;
+                    rotations[i].set(value[0] / scale, value[1] / scale, value[2] / scale, value[3] / scale);
+                }
+                return true;
+            };
+
+            bool valid = false;
+            switch (rotationAccessor->componentType) {
+            case CesiumGltf::Accessor::ComponentType::FLOAT:
+                valid = readRotations(CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC4<float>>(*m_model, *rotationAccessor), 1.0);
+                break;
+            case CesiumGltf::Accessor::ComponentType::SHORT:
+                valid = readRotations(CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC4<int16_t>>(*m_model, *rotationAccessor), 32767.0);
+                break;
+            case CesiumGltf::Accessor::ComponentType::BYTE:
+                valid = readRotations(CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC4<int8_t>>(*m_model, *rotationAccessor), 127.0);
+                break;
+            default:
+                break;
+            }
+            if (!valid) {
+                CO_WARN("Unsupported instance ROTATION accessor (component type {})", rotationAccessor->componentType);
+                return {};
+            }
+            for (int64_t i = 0; i < count; ++i) {
+                instances[i].preMultRotate(rotations[i]);
+            }
+        }
+
+        if (scaleAccessor) {
+            CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC3<float>> view(*m_model, *scaleAccessor);
+            if (view.status() != CesiumGltf::AccessorViewStatus::Valid) {
+                CO_WARN("Invalid instance SCALE accessor: {}", static_cast<int>(view.status()));
+                return {};
+            }
+            for (int64_t i = 0; i < count; ++i) {
+                instances[i].preMultScale(osg::Vec3d(view[i].value[0], view[i].value[1], view[i].value[2]));
+            }
+        }
+
+        CO_TRACE("Decoded {} instance transforms", count);
+        return instances;
+    }
+
+    void NodeBuilder::flattenHierarchy(osg::Group* root) {
+        FlattenCollectVisitor collector;
+        for (unsigned int i = 0; i < root->getNumChildren(); ++i) {
+            root->getChild(i)->accept(collector);
+        }
+
+        osg::ref_ptr<osg::Geode> flatGeode = new osg::Geode;
+        std::vector<osg::ref_ptr<osg::Node>> transformedNodes;
+        for (auto& item : collector.items) {
+            // 实例化几何体的实例变换位于节点变换之内，不能预乘
+            const bool flattenable = !item.geodeStateSet.valid() && !isInstancedGeometry(*item.geometry);
+            if (flattenable && (item.matrix.isIdentity() || transformGeometry(*item.geometry, item.matrix))) {
+                flatGeode->addDrawable(item.geometry);
+            }
+            else {
+                // 无法预乘的几何体保留一个变换节点
+                osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+                geode->setStateSet(item.geodeStateSet.get());
+                geode->addDrawable(item.geometry);
+                osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform(item.matrix);
+                transform->addChild(geode);
+                transformedNodes.push_back(transform);
+            }
+        }
+
+        root->removeChildren(0, root->getNumChildren());
+        if (flatGeode->getNumDrawables() > 0) {
+            root->addChild(flatGeode);
+        }
+        for (auto& node : transformedNodes) {
+            root->addChild(node);
+        }
+
+        CO_TRACE("Flattened {} geometries, {} kept under transforms", flatGeode->getNumDrawables(), transformedNodes.size());
+    }
+
+}	// namespace czmosg
@@ -1,12 +1,27 @@
-#pragma
+#pragma once
+
+#include "Instancing.h"
+#include "StateSetCache.h"
 
 #include <glm/mat4x4.hpp>
 
 #include <CesiumGltf/Node.h>
 #include <CesiumGltf/Mesh.h>
 
+#include <osg/Matrixd>
+#include <osg/ref_ptr>
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace CesiumGltf {
 	struct Model;
+	struct ImageAsset;
+	struct ExtensionExtMeshGpuInstancing;
 }
 
 namespace osg {
@@ -17,25 +32,182 @@ namespace osg {
 	class StateSet;
 	class Material;
 	class Texture2D;
+	class Image;
+	class Referenced;
 }
 
 namespace czmosg
 {
 
+	class TextureCache;
+
+	/**
+	 * @brief NodeBuilder 构建过程的统计信息
+	 */
+	struct NodeBuilderStatistics
+	{
+		// 新创建的纹理数
+		unsigned int texturesCreated = 0;
+		// 模型内重复引用而复用的纹理数
+		unsigned int texturesShared = 0;
+		// 从跨瓦片缓存中复用的纹理数
+		unsigned int texturesSharedAcrossTiles = 0;
+		// 因复用纹理而免于再次上传/保存的像素字节数
+		uint64_t textureBytesSaved = 0;
+		// 压平前后的场景节点数（包括 Drawable；未压平时两者相同）
+		unsigned int sceneNodesBeforeFlatten = 0;
+		unsigned int sceneNodes = 0;
+		// EXT_mesh_gpu_instancing：改为实例化绘制的几何体数和实例总数
+		unsigned int instancedGeometries = 0;
+		unsigned int instances = 0;
+		// 点云图元数和点数
+		unsigned int pointPrimitives = 0;
+		uint64_t points = 0;
+		// 超过纹理尺寸上限而缩小的图像数
+		unsigned int texturesDownscaled = 0;
+
+		NodeBuilderStatistics& operator+=(const NodeBuilderStatistics& other)
+		{
+			texturesCreated += other.texturesCreated;
+			texturesShared += other.texturesShared;
+			texturesSharedAcrossTiles += other.texturesSharedAcrossTiles;
+			textureBytesSaved += other.textureBytesSaved;
+			sceneNodesBeforeFlatten += other.sceneNodesBeforeFlatten;
+			sceneNodes += other.sceneNodes;
+			instancedGeometries += other.instancedGeometries;
+			instances += other.instances;
+			pointPrimitives += other.pointPrimitives;
+			points += other.points;
+			texturesDownscaled += other.texturesDownscaled;
+			return *this;
+		}
+	};
+
+	/**
+	 * @brief 需要在主线程中挂接的共享状态
+	 * 跨瓦片共享的纹理和全局共享的 StateSet 会被其它瓦片同时绘制，其父节点列表不是线程安全的，加载线程中只记录，
+	 * 在主线程中（瓦片加入场景图之前）调用 bind() 挂接到瓦片上。
+	 */
+	struct SharedStateBindings
+	{
+		// 瓦片的 StateSet 及其第 0 层应使用的共享纹理
+		std::vector<std::pair<osg::ref_ptr<osg::StateSet>, osg::ref_ptr<osg::Texture2D>>> textures;
+
+		// 加载线程中使用的占位 StateSet 及替换它的共享 StateSet
+		std::vector<std::pair<osg::ref_ptr<osg::StateSet>, osg::ref_ptr<osg::StateSet>>> stateSets;
+
+		bool empty() const { return textures.empty() && stateSets.empty(); }
+
+		void bind();
+	};
+
 	class NodeBuilder {
 	public:
+		using StateSetMap = std::unordered_map<StateSetKey, osg::ref_ptr<osg::StateSet>, StateSetKeyHash>;
+
 		NodeBuilder(CesiumGltf::Model* model, const glm::dmat4& transform);
+		~NodeBuilder();
 
 		osg::Node* build();
 
+		// 设置是否压平节点层级：静态变换预乘进几何体，每个模型只输出一个 Geode
+		void setFlattenHierarchy(bool flatten) { m_flattenHierarchy = flatten; }
+
+		// 设置是否使用瓦片的渲染状态：线性基础颜色、没有材质时使用不覆盖下层状态的白色默认材质，
+		// 不设置光照和深度测试模式；双面材质和没有材质的图元不做背面剔除
+		void setTileRenderState(bool tileRenderState) { m_tileRenderState = tileRenderState; }
+
+		// 设置跨瓦片共享的纹理缓存（可选，为空时只在模型内部去重）
+		void setTextureCache(TextureCache* textureCache) { m_textureCache = textureCache; }
+
+		// 设置纹理宽高上限，超过时按 2 的幂次缩小，0 表示不限制
+		void setMaximumTextureSize(unsigned int size) { m_maximumTextureSize = size; }
+
+		const NodeBuilderStatistics& getStatistics() const { return m_statistics; }
+
+		// 构建过程中创建的 StateSet（模型内已按内容去重），可用于跨瓦片共享
+		const StateSetMap& getStateSets() const { return m_stateSets; }
+
+		// 构建结果中引用的、不归本模型所有的共享资源（跨瓦片纹理、全局共享的 StateSet），内存统计时应排除
+		const std::set<const osg::Referenced*>& getSharedResources() const { return m_sharedResources; }
+
+		// 取出需要在主线程中挂接的共享状态（未设置跨瓦片缓存、也没有实例化和点云几何体时为空）
+		SharedStateBindings takeSharedStateBindings() { return std::move(m_sharedStateBindings); }
+
+		// 直接引用模型中 ImageAsset 像素内存的图像；模型保留对 ImageAsset 的引用，像素由 cesium-native 随模型统计
+		const std::set<const osg::Referenced*>& getModelImages() const { return m_modelImages; }
+
 	private:
 		osg::Node* createNode(const CesiumGltf::Node& node);
 
 		osg::Node* createMesh(const CesiumGltf::Mesh& mesh);
 
+		// 创建点云几何体：位置和颜色保持紧凑存储，使用共享的点云着色器
+		osg::Geometry* createPointCloud(const CesiumGltf::MeshPrimitive& primitive);
+
+		// 解码 EXT_mesh_gpu_instancing 的每实例变换（OSG 行向量约定）
+		std::vector<osg::Matrixd> readInstanceTransforms(const CesiumGltf::ExtensionExtMeshGpuInstancing& instancing) const;
+
+		// 统计子图中的节点数（包括 Drawable）
+		unsigned int countNodes(osg::Node* node) const;
+
+		// 将 root 下的层级压平为一个 Geode
+		void flattenHierarchy(osg::Group* root);
+
+		// 获取（或创建）与内容键对应的 StateSet，模型内相同内容只创建一次
+		osg::StateSet* getOrCreateStateSet(const StateSetKey& key);
+
+		// 获取（或创建）与内容键对应的材质
+		osg::Material* getOrCreateMaterial(const MaterialKey& key);
+
+		// 创建（或复用）glTF 纹理对应的 osg::Texture2D
+		osg::Texture2D* createTexture(int32_t textureIndex);
+
+		// 图像是否超过纹理尺寸上限且格式支持缩小
+		bool shouldDownscale(const CesiumGltf::ImageAsset& imageAsset) const;
+
+		// 创建直接引用 ImageAsset 像素内存的 osg::Image（不复制像素数据）
+		osg::Image* createImage(int32_t imageIndex);
+
+		// 释放模型中已由缩小的副本或共享纹理替代的 ImageAsset 引用
+		void releaseReplacedImages();
+
+		// 创建代替全局共享 StateSet 的占位 StateSet，由主线程在 SharedStateBindings::bind() 中替换
+		osg::StateSet* createPlaceholderStateSet(osg::StateSet* sharedStateSet);
+
 	private:
 		CesiumGltf::Model* m_model;
 		glm::dmat4 m_transform;
+
+		bool m_flattenHierarchy = false;
+		bool m_tileRenderState = false;
+		TextureCache* m_textureCache = nullptr;
+		unsigned int m_maximumTextureSize = 0;
+		NodeBuilderStatistics m_statistics;
+
+		// 模型内去重：按图像索引缓存 osg::Image，按（图像, 采样器）索引缓存 osg::Texture2D
+		std::map<int32_t, osg::ref_ptr<osg::Image>> m_images;
+		std::map<std::pair<int32_t, int32_t>, osg::ref_ptr<osg::Texture2D>> m_textures;
+
+		// 模型内去重：按内容缓存 StateSet 和材质
+		StateSetMap m_stateSets;
+		std::unordered_map<MaterialKey, osg::ref_ptr<osg::Material>, MaterialKeyHash> m_materials;
+
+		// 已由缩小的副本或共享纹理替代、模型中不再需要的图像索引
+		std::set<int32_t> m_replacedImages;
+
+		std::set<const osg::Referenced*> m_sharedResources;
+		std::set<const osg::Referenced*> m_modelImages;
+
+		// 从跨瓦片缓存中取得的纹理不在加载线程中挂接，记录在此由主线程挂接
+		std::set<const osg::Texture2D*> m_cachedTextures;
+		SharedStateBindings m_sharedStateBindings;
+
+		// 本模型实例化几何体使用的占位 StateSet（首次遇到 EXT_mesh_gpu_instancing 时创建）
+		InstancingStateSets m_instancingStateSets;
+
+		// 本模型点云几何体使用的占位 StateSet（首次遇到点云图元时创建）
+		osg::ref_ptr<osg::StateSet> m_pointCloudStateSet;
 	};
 
 }	// namespace czmosg
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "PointCloud.h"
+
+#include <osg/Program>
+#include <osg/Shader>
+#include <osg/Uniform>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		const char* POINT_CLOUD_VERTEX_SHADER = R"(
+#version 120
+attribute vec3 pointPosition;
+attribute vec4 pointColor;
+uniform float pointSize;
+uniform float minPointSize;
+uniform float maxPointSize;
+uniform float attenuationDistance;
+varying vec4 vertexColor;
+
+void main()
+{
+    vec4 eyePosition = gl_ModelViewMatrix * vec4(pointPosition, 1.0);
+    float distance = max(length(eyePosition.xyz), 1.0);
+    gl_PointSize = clamp(pointSize * attenuationDistance / distance, minPointSize, maxPointSize);
+
+    vertexColor = pointColor;
+    gl_Position = gl_ProjectionMatrix * eyePosition;
+}
+)";
+
+		const char* POINT_CLOUD_FRAGMENT_SHADER = R"(
+#version 120
+varying vec4 vertexColor;
+
+void main()
+{
+    gl_FragColor = vertexColor;
+}
+)";
+
+		osg::ref_ptr<osg::StateSet> createPointCloudStateSet()
+		{
+			osg::ref_ptr<osg::Program> program = new osg::Program;
+			program->setName("czmosg_point_cloud");
+			program->addShader(new osg::Shader(osg::Shader::VERTEX, POINT_CLOUD_VERTEX_SHADER));
+			program->addShader(new osg::Shader(osg::Shader::FRAGMENT, POINT_CLOUD_FRAGMENT_SHADER));
+			program->addBindAttribLocation("pointPosition", POINT_POSITION);
+			program->addBindAttribLocation("pointColor", POINT_COLOR);
+
+			osg::ref_ptr<osg::StateSet> stateSet = new osg::StateSet;
+			stateSet->setAttributeAndModes(program.get());
+			stateSet->setMode(GL_VERTEX_PROGRAM_POINT_SIZE, osg::StateAttribute::ON);
+			stateSet->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+			stateSet->addUniform(new osg::Uniform("pointSize", 2.0f));
+			stateSet->addUniform(new osg::Uniform("minPointSize", 1.0f));
+			stateSet->addUniform(new osg::Uniform("maxPointSize", 8.0f));
+			stateSet->addUniform(new osg::Uniform("attenuationDistance", 100.0f));
+			return stateSet;
+		}
+	}
+
+	osg::StateSet* getPointCloudStateSet()
+	{
+		// StateSet 内容固定，所有瓦片共享，不会随瓦片释放
+		static osg::ref_ptr<osg::StateSet> s_stateSet = createPointCloudStateSet();
+		return s_stateSet.get();
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <osg/StateSet>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 点云绘制使用的顶点属性位置
+	 * 位置和颜色以 glTF 中的紧凑格式（量化的 short、RGB/RGBA8）直接作为通用顶点属性上传，不展开为 float。
+	 */
+	enum PointCloudAttributeLocation
+	{
+		POINT_POSITION = 0,
+		POINT_COLOR = 3
+	};
+
+	/**
+	 * @brief 获取点云共享的 StateSet（着色器程序 + 点大小衰减），所有瓦片共用同一份
+	 * 点大小（像素）随距离衰减：size = pointSize * attenuationDistance / distance，限制在 [minPointSize, maxPointSize]。
+	 * 可通过 StateSet 上的同名 uniform 调整这些参数，对所有已加载和之后加载的瓦片生效。
+	 */
+	osg::StateSet* getPointCloudStateSet();
+
+}	// namespace czmosg
@@ -0,0 +1,82 @@
+#include "ScreenSpaceErrorController.h"
+#include "Log.h"
+
+#include <algorithm>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 帧时间指数平滑系数
+		constexpr double SMOOTHING = 0.1;
+		// 帧时间在目标的 [LOWER, UPPER] 倍之间时不调整
+		constexpr double UPPER_RATIO = 1.1;
+		constexpr double LOWER_RATIO = 0.8;
+		// 单次调整的最大增幅和固定降幅
+		constexpr double MAX_INCREASE = 1.25;
+		constexpr double DECREASE = 0.95;
+		// 忽略异常帧（如窗口拖动、断点）对平滑值的影响
+		constexpr double MAX_FRAME_TIME = 1.0;
+	}
+
+	void ScreenSpaceErrorController::setRange(float minimum, float maximum)
+	{
+		m_minimum = std::max(0.1f, std::min(minimum, maximum));
+		m_maximum = std::max(m_minimum, maximum);
+	}
+
+	void ScreenSpaceErrorController::setTargetFrameRate(double frameRate)
+	{
+		if (frameRate > 0.0) {
+			m_targetFrameTime = 1.0 / frameRate;
+		}
+	}
+
+	void ScreenSpaceErrorController::reset()
+	{
+		m_smoothedFrameTime = 0.0;
+		m_framesSinceAdjust = 0;
+	}
+
+	float ScreenSpaceErrorController::update(float currentError, const Sample& sample)
+	{
+		if (sample.frameTime > 0.0 && sample.frameTime < MAX_FRAME_TIME) {
+			m_smoothedFrameTime = m_smoothedFrameTime > 0.0
+				? m_smoothedFrameTime + SMOOTHING * (sample.frameTime - m_smoothedFrameTime)
+				: sample.frameTime;
+		}
+
+		if (++m_framesSinceAdjust < ADJUST_INTERVAL || m_smoothedFrameTime <= 0.0) {
+			return std::clamp(currentError, m_minimum, m_maximum);
+		}
+
+		const double frameRatio = m_smoothedFrameTime / m_targetFrameTime;
+		const double triangleRatio = m_triangleBudget > 0 ? double(sample.visibleTriangles) / double(m_triangleBudget) : 0.0;
+		const bool loadBacklog = sample.workerThreadLoadQueueLength + sample.mainThreadLoadQueueLength > m_loadQueueThreshold;
+
+		// 取帧时间和三角形数中超出更多的一项作为压力，加载积压时至少按小幅超出处理
+		double pressure = std::max(frameRatio, triangleRatio);
+		if (loadBacklog) {
+			pressure = std::max(pressure, UPPER_RATIO + 0.05);
+		}
+
+		double error = currentError;
+		if (pressure > UPPER_RATIO) {
+			error *= std::min(pressure, MAX_INCREASE);
+		}
+		else if (frameRatio < LOWER_RATIO && triangleRatio < LOWER_RATIO && !loadBacklog) {
+			error *= DECREASE;
+		}
+
+		const float result = std::clamp(static_cast<float>(error), m_minimum, m_maximum);
+		if (result != currentError) {
+			m_framesSinceAdjust = 0;
+			CO_DEBUG("Adaptive SSE: {:.2f} -> {:.2f} (frame {:.2f} ms, target {:.2f} ms, {} triangles, {} queued loads)",
+				currentError, result, m_smoothedFrameTime * 1000.0, m_targetFrameTime * 1000.0, sample.visibleTriangles,
+				sample.workerThreadLoadQueueLength + sample.mainThreadLoadQueueLength);
+		}
+		return result;
+	}
+
+}	// namespace czmosg
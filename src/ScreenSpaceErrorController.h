@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 自适应屏幕空间误差控制器：在给定范围内调整 maximumScreenSpaceError，使帧时间保持在目标预算内
+	 * 帧时间经过指数平滑后与目标比较，超出预算（或可见三角形数超出预算、加载队列积压）时按比例增大 SSE，
+	 * 明显低于预算且没有积压时缓慢减小 SSE。每 ADJUST_INTERVAL 帧最多调整一次，
+	 * 给瓦片选择和加载留出响应时间，避免来回振荡。
+	 */
+	class ScreenSpaceErrorController
+	{
+	public:
+		// 一帧的测量值
+		struct Sample
+		{
+			// 帧时间（秒）
+			double frameTime = 0.0;
+			// 当前渲染的三角形数
+			uint64_t visibleTriangles = 0;
+			// cesium-native 报告的加载队列长度
+			uint32_t workerThreadLoadQueueLength = 0;
+			uint32_t mainThreadLoadQueueLength = 0;
+		};
+
+		// 两次调整之间至少间隔的帧数
+		static constexpr unsigned int ADJUST_INTERVAL = 10;
+
+		// 设置 SSE 的调整范围
+		void setRange(float minimum, float maximum);
+		float getMinimum() const { return m_minimum; }
+		float getMaximum() const { return m_maximum; }
+
+		// 设置目标帧率
+		void setTargetFrameRate(double frameRate);
+		double getTargetFrameRate() const { return 1.0 / m_targetFrameTime; }
+
+		// 设置可见三角形预算，0 表示不限制
+		void setTriangleBudget(uint64_t triangles) { m_triangleBudget = triangles; }
+		uint64_t getTriangleBudget() const { return m_triangleBudget; }
+
+		// 设置加载队列积压阈值：两个队列总长度超过该值时视为加载跟不上
+		void setLoadQueueThreshold(uint32_t threshold) { m_loadQueueThreshold = threshold; }
+		uint32_t getLoadQueueThreshold() const { return m_loadQueueThreshold; }
+
+		// 获取平滑后的帧时间（秒）
+		double getSmoothedFrameTime() const { return m_smoothedFrameTime; }
+
+		// 每帧调用，返回新的 SSE（不需要调整时返回 currentError）
+		float update(float currentError, const Sample& sample);
+
+		// 丢弃平滑状态（例如重新启用控制器时）
+		void reset();
+
+	private:
+		float m_minimum = 16.0f;
+		float m_maximum = 64.0f;
+		double m_targetFrameTime = 1.0 / 30.0;
+		uint64_t m_triangleBudget = 0;
+		uint32_t m_loadQueueThreshold = 64;
+
+		double m_smoothedFrameTime = 0.0;
+		unsigned int m_framesSinceAdjust = 0;
+	};
+
+}	// namespace czmosg
@@ -8,6 +8,7 @@
 
 #include <fstream>
 #include <algorithm>
+#include <chrono>
 
 // CURL写入回调函数
 static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::vector<std::byte>* data)
@@ -94,7 +95,10 @@ SimpleAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
         }
     }
     
-    return asyncSystem.runInWorkerThread([this, &asyncSystem, verb, resolvedUrl, headers, contentPayload]() {
+    ++m_requestsStarted;
+    const auto start = std::chrono::steady_clock::now();
+
+    return asyncSystem.runInWorkerThread([this, &asyncSystem, verb, resolvedUrl, headers, contentPayload, start]() {
         std::shared_ptr<CesiumAsync::IAssetRequest> request;
         
         if (isHttpUrl(resolvedUrl)) {
@@ -114,11 +118,29 @@ SimpleAssetAccessor::request(const CesiumAsync::AsyncSystem& asyncSystem,
             simpleRequest->setResponse(std::move(response));
             request = simpleRequest;
         }
+
+        // 记录从发起到完成的耗时（包括在任务队列中的等待），用于调整加载并发数
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        m_requestMicroseconds += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        if (request && request->response()) {
+            m_bytesReceived += request->response()->data().size();
+        }
+        ++m_requestsCompleted;
         
         return request;
     });
 }
 
+SimpleAssetAccessor::Statistics SimpleAssetAccessor::getStatistics() const
+{
+    Statistics statistics;
+    statistics.requestsStarted = m_requestsStarted;
+    statistics.requestsCompleted = m_requestsCompleted;
+    statistics.bytesReceived = m_bytesReceived;
+    statistics.requestTime = m_requestMicroseconds * 1e-6;
+    return statistics;
+}
+
 void SimpleAssetAccessor::tick() noexcept {
     // 这里可以处理异步操作的清理工作
 }
@@ -5,6 +5,8 @@
 #include <CesiumAsync/IAssetResponse.h>
 #include <CesiumUtility/Uri.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,6 +44,20 @@ public:
     
     // 设置基础URL用于解析相对URL
     void setBaseUrl(const std::string& baseUrl);
+
+    // 请求统计（累计值）
+    struct Statistics
+    {
+        uint64_t requestsStarted = 0;
+        uint64_t requestsCompleted = 0;
+        uint64_t bytesReceived = 0;
+        // 所有已完成请求的耗时之和（秒）
+        double requestTime = 0.0;
+
+        uint64_t requestsInFlight() const { return requestsStarted - requestsCompleted; }
+    };
+
+    Statistics getStatistics() const;
     
 private:
     // HTTP请求实现
@@ -68,6 +84,11 @@ private:
     
     // 基础URL用于解析相对URL
     std::string m_baseUrl;
+
+    std::atomic<uint64_t> m_requestsStarted{0};
+    std::atomic<uint64_t> m_requestsCompleted{0};
+    std::atomic<uint64_t> m_bytesReceived{0};
+    std::atomic<uint64_t> m_requestMicroseconds{0};
 };
 
 /**
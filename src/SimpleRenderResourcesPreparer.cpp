@@ -1,13 +1,10 @@
 #include "SimpleRenderResourcesPreparer.h"
-//#include "NodeBuilder.h"
 #include "Log.h"
 
-#include <CesiumGltfContent/GltfUtilities.h>
-#include <CesiumGltf/AccessorView.h>
-
 #include <osg/Geode>
 #include <osg/Texture2D>
 #include <osg/Geometry>
+#include <osg/Image>
 #include <osg/Notify>
 #include <osg/MatrixTransform>
 #include <osg/Material>
@@ -15,6 +12,9 @@
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <set>
+
 
 //static bool startsWith(const std::string& str, const std::string& prefix)
 //{
@@ -92,327 +92,6 @@ LoadRasterMainThreadResult::~LoadRasterMainThreadResult()
 }
 
 
-namespace {
-
-	// 将glTF AccessorView转换为OSG数组的模板函数
-	template<typename T>
-	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<T>& accessorView) {
-		return nullptr;
-	}
-
-	template<>
-	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC3<float>>& accessorView) {
-		osg::Vec3Array* result = new osg::Vec3Array(static_cast<unsigned int>(accessorView.size()));
-		for (unsigned int i = 0; i < static_cast<unsigned int>(accessorView.size()); ++i) {
-			auto& data = accessorView[i];
-			(*result)[static_cast<unsigned int>(i)] = osg::Vec3(data.value[0], data.value[1], data.value[2]);
-		}
-		return result;
-	}
-
-	template<>
-	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC2<float>>& accessorView) {
-		osg::Vec2Array* result = new osg::Vec2Array(static_cast<unsigned int>(accessorView.size()));
-		for (unsigned int i = 0; i < static_cast<unsigned int>(accessorView.size()); ++i) {
-			auto& data = accessorView[i];
-			(*result)[i] = osg::Vec2(data.value[0], data.value[1]);
-		}
-		return result;
-	}
-
-	template<>
-	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint16_t>>& accessorView) {
-		osg::UShortArray* result = new osg::UShortArray(static_cast<unsigned int>(accessorView.size()));
-		for (unsigned int i = 0; i < static_cast<unsigned int>(accessorView.size()); ++i) {
-			auto& data = accessorView[i];
-			(*result)[i] = data.value[0];
-		}
-		return result;
-	}
-
-	template<>
-	osg::Array* accessorViewToArray(const CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint32_t>>& accessorView) {
-		osg::UIntArray* result = new osg::UIntArray(static_cast<unsigned int>(accessorView.size()));
-		for (unsigned int i = 0; i < static_cast<unsigned int>(accessorView.size()); ++i) {
-			auto& data = accessorView[i];
-			(*result)[i] = data.value[0];
-		}
-		return result;
-	}
-
-	// NodeBuilder类：将glTF模型转换为OSG节点
-	class NodeBuilder {
-	public:
-		NodeBuilder(CesiumGltf::Model* model, const glm::dmat4& transform)
-			: _model(model), _transform(transform) {
-		}
-
-		osg::Node* build() {
-			osg::MatrixTransform* root = new osg::MatrixTransform;
-			osg::Matrixd matrix;
-
-			glm::dmat4x4 rootTransform = _transform;
-			rootTransform = CesiumGltfContent::GltfUtilities::applyRtcCenter(*_model, rootTransform);
-			rootTransform = CesiumGltfContent::GltfUtilities::applyGltfUpAxisTransform(*_model, rootTransform);
-			matrix.set(glm::value_ptr(rootTransform));
-
-			root->setMatrix(matrix);
-
-			if (!_model->scenes.empty()) {
-				for (auto& scene : _model->scenes) {
-					for (int node : scene.nodes) {
-						root->addChild(createNode(_model->nodes[node]));
-					}
-				}
-			}
-			else {
-				for (auto itr = _model->nodes.begin(); itr != _model->nodes.end(); ++itr) {
-					root->addChild(createNode(*itr));
-				}
-			}
-
-			osg::Group* container = new osg::Group;
-			container->addChild(root);
-			return container;
-		}
-
-	private:
-		osg::Node* createNode(const CesiumGltf::Node& node) {
-			osg::MatrixTransform* root = new osg::MatrixTransform;
-
-			if (node.matrix.size() == 16) {
-				osg::Matrixd matrix;
-				matrix.set(node.matrix.data());
-				root->setMatrix(matrix);
-			}
-
-			if (root->getMatrix().isIdentity()) {
-				osg::Matrixd scale, translation, rotation;
-				if (node.scale.size() == 3) {
-					scale = osg::Matrixd::scale(node.scale[0], node.scale[1], node.scale[2]);
-				}
-
-				if (node.rotation.size() == 4) {
-					osg::Quat quat(node.rotation[0], node.rotation[1], node.rotation[2], node.rotation[3]);
-					rotation.makeRotate(quat);
-				}
-
-				if (node.translation.size() == 3) {
-					translation = osg::Matrixd::translate(node.translation[0], node.translation[1], node.translation[2]);
-				}
-
-				root->setMatrix(scale * rotation * translation);
-			}
-
-			if (node.mesh >= 0) {
-				root->addChild(createMesh(_model->meshes[node.mesh]));
-			}
-
-			for (int child : node.children) {
-				root->addChild(createNode(_model->nodes[child]));
-			}
-
-			return root;
-		}
-
-		osg::Node* createMesh(const CesiumGltf::Mesh& mesh) {
-			osg::Group* group = new osg::Group;
-
-			CO_TRACE("Creating mesh with {} primitives", mesh.primitives.size());
-
-			for (const auto& primitive : mesh.primitives) {
-				osg::Geometry* geometry = new osg::Geometry;
-
-				// 处理顶点属性
-				for (const auto& attribute : primitive.attributes) {
-					const std::string& attributeName = attribute.first;
-					int accessorIndex = attribute.second;
-
-					if (accessorIndex < 0 || accessorIndex >= _model->accessors.size()) {
-						continue;
-					}
-
-					const auto& accessor = _model->accessors[accessorIndex];
-
-					if (attributeName == "POSITION") {
-						auto positionView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC3<float>>(*_model, accessor);
-						if (positionView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-							osg::Array* vertices = accessorViewToArray(positionView);
-							if (vertices) {
-								geometry->setVertexArray(vertices);
-							}
-						}
-					}
-					else if (attributeName == "NORMAL") {
-						auto normalView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC3<float>>(*_model, accessor);
-						if (normalView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-							osg::Array* normals = accessorViewToArray(normalView);
-							if (normals) {
-								geometry->setNormalArray(normals);
-								geometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
-							}
-						}
-					}
-					else if (attributeName == "TEXCOORD_0") {
-						auto texCoordView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::VEC2<float>>(*_model, accessor);
-						if (texCoordView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-							osg::Array* texCoords = accessorViewToArray(texCoordView);
-							if (texCoords) {
-								geometry->setTexCoordArray(0, texCoords);
-							}
-						}
-					}
-				}
-
-				// 处理索引
-				if (primitive.indices >= 0 && primitive.indices < _model->accessors.size()) {
-					const auto& indexAccessor = _model->accessors[primitive.indices];
-
-					if (indexAccessor.componentType == CesiumGltf::Accessor::ComponentType::UNSIGNED_SHORT) {
-						auto indexView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint16_t>>(*_model, indexAccessor);
-						if (indexView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-							osg::UShortArray* indices = static_cast<osg::UShortArray*>(accessorViewToArray(indexView));
-							if (indices) {
-								osg::DrawElementsUShort* drawElements = new osg::DrawElementsUShort(osg::PrimitiveSet::TRIANGLES);
-								for (size_t i = 0; i < indices->size(); ++i) {
-									drawElements->push_back((*indices)[i]);
-								}
-								geometry->addPrimitiveSet(drawElements);
-							}
-						}
-					}
-					else if (indexAccessor.componentType == CesiumGltf::Accessor::ComponentType::UNSIGNED_INT) {
-						auto indexView = CesiumGltf::AccessorView<CesiumGltf::AccessorTypes::SCALAR<uint32_t>>(*_model, indexAccessor);
-						if (indexView.status() == CesiumGltf::AccessorViewStatus::Valid) {
-							osg::UIntArray* indices = static_cast<osg::UIntArray*>(accessorViewToArray(indexView));
-							if (indices) {
-								osg::DrawElementsUInt* drawElements = new osg::DrawElementsUInt(osg::PrimitiveSet::TRIANGLES);
-								for (size_t i = 0; i < indices->size(); ++i) {
-									drawElements->push_back((*indices)[i]);
-								}
-								geometry->addPrimitiveSet(drawElements);
-							}
-						}
-					}
-				}
-				else {
-					// 没有索引，使用顶点数组
-					if (geometry->getVertexArray()) {
-						geometry->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::TRIANGLES, 0, geometry->getVertexArray()->getNumElements()));
-					}
-				}
-
-				// 处理材质和纹理
-				osg::StateSet* stateSet = geometry->getOrCreateStateSet();
-
-				// 检查primitive是否有材质
-				if (primitive.material >= 0 && primitive.material < _model->materials.size()) {
-					const auto& material = _model->materials[primitive.material];
-					CO_TRACE("Processing material {}", primitive.material);
-					// 处理PBR材质
-					if (material.pbrMetallicRoughness) {
-						const auto& pbr = *material.pbrMetallicRoughness;
-
-						// 设置基础颜色
-						if (pbr.baseColorFactor.size() >= 4) {
-							osg::Vec4 baseColor(
-								pbr.baseColorFactor[0],
-								pbr.baseColorFactor[1],
-								pbr.baseColorFactor[2],
-								pbr.baseColorFactor[3]
-							);
-							CO_TRACE("Base color: ({}, {}, {}, {})", baseColor.r(), baseColor.g(), baseColor.b(), baseColor.a());
-
-							osg::Material* osgMaterial = new osg::Material;
-							osgMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, baseColor);
-							osgMaterial->setAmbient(osg::Material::FRONT_AND_BACK, baseColor * 0.2f);
-							stateSet->setAttributeAndModes(osgMaterial, osg::StateAttribute::ON);
-						}
-
-						// 处理基础颜色纹理
-						if (pbr.baseColorTexture && pbr.baseColorTexture->index >= 0 && pbr.baseColorTexture->index < _model->textures.size()) {
-							const auto& texture = _model->textures[pbr.baseColorTexture->index];
-							CO_TRACE("Loading base color texture {}", pbr.baseColorTexture->index);
-
-							if (texture.source >= 0 && texture.source < _model->images.size()) {
-								const auto& image = _model->images[texture.source];
-
-								// 检查图像资产是否存在
-								if (image.pAsset && !image.pAsset->pixelData.empty()) {
-									const auto& imageAsset = *image.pAsset;
-									CO_TRACE("Image source {} , data size: {}", texture.source, imageAsset.pixelData.size());
-
-									osg::Texture2D* osgTexture = new osg::Texture2D;
-
-									// 创建OSG图像
-									osg::Image* osgImage = new osg::Image;
-
-									// 确定图像格式
-									GLenum pixelFormat = GL_RGB;
-									GLenum dataType = GL_UNSIGNED_BYTE;
-									GLint internalFormat = GL_RGB8;
-
-									if (imageAsset.channels == 4) {
-										pixelFormat = GL_RGBA;
-										internalFormat = GL_RGBA8;
-									}
-									else if (imageAsset.channels == 3) {
-										pixelFormat = GL_RGB;
-										internalFormat = GL_RGB8;
-									}
-									CO_TRACE("Image format: {}x{}, channels: {}", imageAsset.width, imageAsset.height, imageAsset.channels);
-
-									// 复制像素数据
-									unsigned char* imageData = new unsigned char[imageAsset.pixelData.size()];
-									std::memcpy(imageData, imageAsset.pixelData.data(), imageAsset.pixelData.size());
-
-									osgImage->setImage(
-										imageAsset.width,
-										imageAsset.height,
-										1, // depth
-										internalFormat,
-										pixelFormat,
-										dataType,
-										imageData,
-										osg::Image::USE_NEW_DELETE
-									);
-
-									osgTexture->setImage(osgImage);
-									osgTexture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::REPEAT);
-									osgTexture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::REPEAT);
-									osgTexture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR_MIPMAP_LINEAR);
-									osgTexture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::LINEAR);
-
-									stateSet->setTextureAttributeAndModes(0, osgTexture, osg::StateAttribute::ON);
-									CO_TRACE("Texture applied successfully");
-								}
-							}
-						}
-					}
-				}
-				else {
-					CO_WARN("No material found for primitive, using default white material");
-					// 设置默认白色材质
-					osg::Material* defaultMaterial = new osg::Material;
-					defaultMaterial->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f));
-					defaultMaterial->setAmbient(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.2f, 0.2f, 1.0f));
-					stateSet->setAttributeAndModes(defaultMaterial, osg::StateAttribute::ON);
-				}
-
-				osg::Geode* geode = new osg::Geode;
-				geode->addDrawable(geometry);
-				group->addChild(geode);
-			}
-
-			return group;
-		}
-
-		CesiumGltf::Model* _model;
-		glm::dmat4 _transform;
-	};
-}
-
-
 // ============================== SimpleRenderResourcesPreparer 类实现 ==============================
 
 CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources>
@@ -448,11 +127,47 @@ CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources>
 
 	CO_TRACE("Found glTF model with {} meshes", model->meshes.size());
 
-	//czmosg::NodeBuilder builder(model, transform);
-	NodeBuilder builder(model, transform);
+	// 瓦片与独立模型使用同一个 NodeBuilder，瓦片保持原有的渲染状态
+	czmosg::NodeBuilder builder(model, transform);
+	builder.setTileRenderState(true);
+	if (m_shareTexturesAcrossTiles) {
+		builder.setTextureCache(&m_textureCache);
+	}
+	builder.setFlattenHierarchy(m_flattenHierarchy);
+	builder.setMaximumTextureSize(m_maximumTextureSize);
 	::LoadThreadResult* result = new ::LoadThreadResult;
 	result->node = builder.build();
 
+	const czmosg::NodeBuilderStatistics& buildStatistics = builder.getStatistics();
+	if (buildStatistics.texturesShared > 0 || buildStatistics.texturesSharedAcrossTiles > 0) {
+		CO_DEBUG("Textures: {} created, {} shared in tile, {} shared across tiles, {} bytes saved",
+			buildStatistics.texturesCreated, buildStatistics.texturesShared,
+			buildStatistics.texturesSharedAcrossTiles, buildStatistics.textureBytesSaved);
+	}
+	if (buildStatistics.instancedGeometries > 0) {
+		CO_DEBUG("Instanced rendering: {} geometries, {} instances",
+			buildStatistics.instancedGeometries, buildStatistics.instances);
+	}
+	if (buildStatistics.pointPrimitives > 0) {
+		CO_DEBUG("Point cloud: {} primitives, {} points",
+			buildStatistics.pointPrimitives, buildStatistics.points);
+	}
+	if (m_flattenHierarchy) {
+		CO_DEBUG("Flattened scene graph: {} -> {} nodes",
+			buildStatistics.sceneNodesBeforeFlatten, buildStatistics.sceneNodes);
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_buildStatistics += buildStatistics;
+	}
+
+	// StateSet 和纹理的父节点列表不是线程安全的，跨瓦片共享推迟到主线程中进行
+	result->sharedState = builder.takeSharedStateBindings();
+	if (m_shareStateSetsAcrossTiles) {
+		const czmosg::NodeBuilder::StateSetMap& stateSets = builder.getStateSets();
+		result->stateSets.assign(stateSets.begin(), stateSets.end());
+	}
+
 	if (!result->node.valid()) {
 		CO_ERROR("Failed to build OSG node from glTF model");
 		delete result;
@@ -464,6 +179,56 @@ CesiumAsync::Future<Cesium3DTilesSelection::TileLoadResultAndRenderResources>
 	}
 	CO_DEBUG("Successfully built OSG node");
 
+	// 可选：按 StateSet 和顶点布局合并几何体，在顶点缓存优化之前进行以便优化合并后的结果
+	if (m_mergeGeometries) {
+		czmosg::GeometryMergeStatistics statistics = czmosg::mergeGeometries(result->node.get());
+		if (statistics.geometriesBefore > 0) {
+			CO_DEBUG("Geometry merge: {} -> {} geometries", statistics.geometriesBefore, statistics.geometriesAfter);
+
+			std::lock_guard<std::mutex> lock(m_statisticsMutex);
+			m_geometryMergeStatistics += statistics;
+		}
+	}
+
+	// 可选：对三角形做顶点缓存优化，并重排顶点以提高读取局部性
+	if (m_optimizeVertexCache) {
+		czmosg::VertexCacheStatistics statistics = czmosg::optimizeVertexCache(result->node.get());
+		if (statistics.geometries > 0) {
+			CO_DEBUG("Vertex cache optimization: {} geometries, {} triangles, ACMR {:.3f} -> {:.3f}",
+				statistics.geometries, statistics.triangles, statistics.acmrBefore(), statistics.acmrAfter());
+
+			std::lock_guard<std::mutex> lock(m_statisticsMutex);
+			m_vertexCacheStatistics += statistics;
+		}
+	}
+
+	// 统计本瓦片独占的 OSG 资源，从其他瓦片共享来的纹理和全局 StateSet 不计入；
+	// 直接引用模型像素内存的图像在模型数据保留时由 cesium-native 统计，释放模型数据后改由 OSG 资源统计
+	const bool releaseModelData = m_releaseModelData;
+	std::set<const osg::Referenced*> excluded = builder.getSharedResources();
+	uint64_t modelImageBytes = 0;
+	for (const osg::Referenced* object : builder.getModelImages()) {
+		modelImageBytes += static_cast<const osg::Image*>(object)->getTotalSizeInBytes();
+		if (!releaseModelData) {
+			excluded.insert(object);
+		}
+	}
+	result->byteSize = czmosg::computeNodeByteSize(result->node.get(), &excluded);
+	result->triangles = czmosg::countTriangles(result->node.get());
+	{
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_nodeByteSize += result->byteSize;
+	}
+
+	// 可选：模型数据已转换为 OSG 资源，释放缓冲区和图像，cesium-native 的内存统计随之减少
+	if (releaseModelData) {
+		// 被 osg::Image 引用的像素内存并未释放，只是从 cesium-native 的统计转入 OSG 资源的统计
+		uint64_t releasedBytes = czmosg::releaseModelData(*model);
+		releasedBytes -= std::min(releasedBytes, modelImageBytes);
+		m_releasedModelBytes += releasedBytes;
+		CO_DEBUG("Released {} bytes of glTF data, tile uses {} bytes of OSG resources", releasedBytes, result->byteSize.total());
+	}
+
 	return asyncSystem.createResolvedFuture(
 		Cesium3DTilesSelection::TileLoadResultAndRenderResources{
 			std::move(tileLoadResult),
@@ -481,6 +246,30 @@ void* SimpleRenderResourcesPreparer::prepareInMainThread(
 	::LoadThreadResult* loadThreadResult = reinterpret_cast<::LoadThreadResult*>(pLoadThreadResult);
 	::MainThreadResult* mainThreadResult = new ::MainThreadResult();
 	mainThreadResult->node = loadThreadResult->node;
+	mainThreadResult->byteSize = loadThreadResult->byteSize;
+	mainThreadResult->triangles = loadThreadResult->triangles;
+
+	// 挂接跨瓦片共享的纹理，需在共享 StateSet 之前，缓存中登记的 StateSet 才带有纹理
+	loadThreadResult->sharedState.bind();
+
+	// 用缓存中内容相同的共享 StateSet 替换本瓦片的 StateSet，便于 OSG 状态排序
+	for (auto& [key, stateSet] : loadThreadResult->stateSets) {
+		osg::StateSet* sharedStateSet = m_stateSetCache.share(key, stateSet.get());
+		if (sharedStateSet != stateSet.get()) {
+			osg::StateSet::ParentList parents = stateSet->getParents();
+			for (osg::Node* parent : parents) {
+				parent->setStateSet(sharedStateSet);
+			}
+		}
+	}
+	loadThreadResult->stateSets.clear();
+
+	// 用 cesium-native 的包围体（有内容包围体时优先使用）代替按几何体计算的包围球，并按包围盒剔除
+	if (m_tileBoundingVolumeCulling && mainThreadResult->node.valid()) {
+		const std::optional<Cesium3DTilesSelection::BoundingVolume>& contentBoundingVolume = tile.getContentBoundingVolume();
+		czmosg::setTileBoundingVolume(mainThreadResult->node.get(),
+			contentBoundingVolume ? *contentBoundingVolume : tile.getBoundingVolume());
+	}
 
 	loadThreadResult->node = nullptr;
 	delete loadThreadResult;
@@ -496,13 +285,79 @@ void SimpleRenderResourcesPreparer::free(
 
 	::LoadThreadResult* loadThreadResult = reinterpret_cast<::LoadThreadResult*>(pLoadThreadResult);
 	if (loadThreadResult) {
-		delete loadThreadResult;
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_nodeByteSize -= loadThreadResult->byteSize;
 	}
 
 	::MainThreadResult* mainThreadResult = reinterpret_cast<::MainThreadResult*>(pMainThreadResult);
 	if (mainThreadResult) {
-		delete mainThreadResult;
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_nodeByteSize -= mainThreadResult->byteSize;
+	}
+
+	// 延迟释放：子图的最后一个引用交给释放队列，避免在缓存淘汰过程中析构整棵子图
+	if (m_deferRelease) {
+		if (loadThreadResult) {
+			m_releaseQueue.push(loadThreadResult->node.get());
+		}
+		if (mainThreadResult) {
+			m_releaseQueue.push(mainThreadResult->node.get());
+		}
+	}
+
+	delete loadThreadResult;
+	delete mainThreadResult;
+
+	// 淘汰不再被使用的共享 StateSet 和材质需要遍历整个缓存，一帧内可能释放很多瓦片，统一在 advanceFrame 中执行一次
+	m_stateSetCachePruneRequested = true;
+}
+
+void SimpleRenderResourcesPreparer::advanceFrame()
+{
+	m_releaseQueue.advanceFrame();
+
+	// 瓦片（或延迟析构的瓦片资源）释放后，其引用的共享 StateSet 才能从缓存中淘汰，每帧最多遍历一次缓存
+	uint64_t released = m_releaseQueue.getStatistics().released;
+	const bool pruneRequested = m_stateSetCachePruneRequested.exchange(false);
+	if (released != m_releasedSincePrune || pruneRequested) {
+		m_releasedSincePrune = released;
+		m_stateSetCache.prune();
+	}
+}
+
+czmosg::VertexCacheStatistics SimpleRenderResourcesPreparer::getVertexCacheStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	return m_vertexCacheStatistics;
+}
+
+czmosg::GeometryMergeStatistics SimpleRenderResourcesPreparer::getGeometryMergeStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	return m_geometryMergeStatistics;
+}
+
+czmosg::NodeByteSize SimpleRenderResourcesPreparer::getNodeByteSize() const
+{
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	return m_nodeByteSize;
+}
+
+czmosg::NodeByteSize SimpleRenderResourcesPreparer::getTileByteSize(const Cesium3DTilesSelection::Tile& tile)
+{
+	const Cesium3DTilesSelection::TileRenderContent* renderContent = tile.getContent().getRenderContent();
+	if (!renderContent) {
+		return czmosg::NodeByteSize();
 	}
+
+	const ::MainThreadResult* result = reinterpret_cast<const ::MainThreadResult*>(renderContent->getRenderResources());
+	return result ? result->byteSize : czmosg::NodeByteSize();
+}
+
+czmosg::NodeBuilderStatistics SimpleRenderResourcesPreparer::getBuildStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_statisticsMutex);
+	return m_buildStatistics;
 }
 
 void* SimpleRenderResourcesPreparer::prepareRasterInLoadThread(
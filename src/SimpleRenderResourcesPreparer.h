@@ -4,8 +4,21 @@
 #include <CesiumGltf/Material.h>
 #include <Cesium3DTilesSelection/Tileset.h>
 
+#include "DeferredReleaseQueue.h"
+#include "MemoryUsage.h"
+#include "MeshOptimizer.h"
+#include "NodeBuilder.h"
+#include "StateSetCache.h"
+#include "TextureCache.h"
+#include "TileCulling.h"
+
 #include <osg/Node>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 
 class LoadThreadResult
@@ -14,6 +27,18 @@ public:
 	LoadThreadResult();
 	~LoadThreadResult();
 	osg::ref_ptr< osg::Node > node;
+
+	// 瓦片 OSG 资源占用的字节数
+	czmosg::NodeByteSize byteSize;
+
+	// 瓦片绘制的三角形数
+	uint64_t triangles = 0;
+
+	// 待在主线程中与其它瓦片共享的 StateSet（仅在开启跨瓦片共享时填充）
+	std::vector< std::pair< czmosg::StateSetKey, osg::ref_ptr< osg::StateSet > > > stateSets;
+
+	// 待在主线程中挂接的共享纹理
+	czmosg::SharedStateBindings sharedState;
 };
 
 class MainThreadResult
@@ -22,6 +47,12 @@ public:
 	MainThreadResult();
 	~MainThreadResult();
 	osg::ref_ptr< osg::Node > node;
+
+	// 瓦片 OSG 资源占用的字节数
+	czmosg::NodeByteSize byteSize;
+
+	// 瓦片绘制的三角形数
+	uint64_t triangles = 0;
 };
 
 
@@ -87,4 +118,103 @@ public:
 		const CesiumRasterOverlays::RasterOverlayTile& rasterTile,
 		void* pLoadThreadResult,
 		void* pMainThreadResult) noexcept override;
+
+public:
+	// 设置和获取是否在加载线程中对瓦片几何体执行顶点缓存优化
+	void setOptimizeVertexCache(bool optimize) { m_optimizeVertexCache = optimize; }
+	bool getOptimizeVertexCache() const { return m_optimizeVertexCache; }
+
+	// 设置和获取是否按像素内容在瓦片之间共享纹理
+	void setShareTexturesAcrossTiles(bool share) { m_shareTexturesAcrossTiles = share; }
+	bool getShareTexturesAcrossTiles() const { return m_shareTexturesAcrossTiles; }
+
+	// 设置和获取是否在瓦片之间共享内容相同的 StateSet 和材质
+	void setShareStateSetsAcrossTiles(bool share) { m_shareStateSetsAcrossTiles = share; }
+	bool getShareStateSetsAcrossTiles() const { return m_shareStateSetsAcrossTiles; }
+
+	// 设置和获取是否压平瓦片内的节点层级（静态变换预乘进几何体）
+	void setFlattenHierarchy(bool flatten) { m_flattenHierarchy = flatten; }
+	bool getFlattenHierarchy() const { return m_flattenHierarchy; }
+
+	// 设置和获取是否合并瓦片内 StateSet 和顶点布局相同的几何体以减少绘制调用
+	void setMergeGeometries(bool merge) { m_mergeGeometries = merge; }
+	bool getMergeGeometries() const { return m_mergeGeometries; }
+
+	// 设置和获取是否按瓦片包围体剔除瓦片节点（默认开启，对之后准备的瓦片生效）
+	void setTileBoundingVolumeCulling(bool cull) { m_tileBoundingVolumeCulling = cull; }
+	bool getTileBoundingVolumeCulling() const { return m_tileBoundingVolumeCulling; }
+
+	// 设置和获取新加载瓦片的纹理宽高上限，超过时在加载线程中缩小，0 表示不限制（由内存压力调节器设置）
+	void setMaximumTextureSize(unsigned int size) { m_maximumTextureSize = size; }
+	unsigned int getMaximumTextureSize() const { return m_maximumTextureSize; }
+
+	// 设置和获取是否在转换为 OSG 资源后释放 glTF 模型中的缓冲区和图像，避免同一瓦片在内存中保存两份
+	void setReleaseModelData(bool release) { m_releaseModelData = release; }
+	bool getReleaseModelData() const { return m_releaseModelData; }
+
+	// 设置和获取是否把释放的瓦片资源放入延迟队列，在后台线程中分批析构（默认开启）
+	void setDeferRelease(bool defer) { m_deferRelease = defer; }
+	bool getDeferRelease() const { return m_deferRelease; }
+
+	// 设置每帧最多析构的瓦片资源数
+	void setReleaseBatchSize(unsigned int batchSize) { m_releaseQueue.setBatchSize(batchSize); }
+	unsigned int getReleaseBatchSize() const { return m_releaseQueue.getBatchSize(); }
+
+	// 每帧在主线程中调用一次，推进延迟释放队列并淘汰不再被使用的共享 StateSet
+	void advanceFrame();
+
+	// 获取延迟释放队列的统计
+	czmosg::DeferredReleaseQueue::Statistics getReleaseStatistics() const { return m_releaseQueue.getStatistics(); }
+
+	// 获取当前所有瓦片 OSG 资源占用的字节数
+	uint64_t getNodeBytes() const { return getNodeByteSize().total(); }
+
+	// 获取当前所有瓦片 OSG 资源占用的字节数（按类别）
+	czmosg::NodeByteSize getNodeByteSize() const;
+
+	// 获取单个瓦片 OSG 资源占用的字节数（瓦片没有渲染资源时为 0）
+	static czmosg::NodeByteSize getTileByteSize(const Cesium3DTilesSelection::Tile& tile);
+
+	// 获取累计从 glTF 模型中释放的字节数
+	uint64_t getReleasedModelBytes() const { return m_releasedModelBytes; }
+
+	// 获取顶点缓存优化的累计统计（所有已加载瓦片）
+	czmosg::VertexCacheStatistics getVertexCacheStatistics() const;
+
+	// 获取几何体合并的累计统计（所有已加载瓦片）
+	czmosg::GeometryMergeStatistics getGeometryMergeStatistics() const;
+
+	// 获取节点构建（纹理复用等）的累计统计（所有已加载瓦片）
+	czmosg::NodeBuilderStatistics getBuildStatistics() const;
+
+	// 获取跨瓦片纹理缓存的统计
+	czmosg::TextureCache::Statistics getTextureCacheStatistics() const { return m_textureCache.getStatistics(); }
+
+	// 获取跨瓦片 StateSet 缓存的统计
+	czmosg::StateSetCache::Statistics getStateSetCacheStatistics() const { return m_stateSetCache.getStatistics(); }
+
+private:
+	std::atomic<bool> m_optimizeVertexCache{ false };
+	std::atomic<bool> m_shareTexturesAcrossTiles{ false };
+	std::atomic<bool> m_shareStateSetsAcrossTiles{ false };
+	std::atomic<bool> m_flattenHierarchy{ false };
+	std::atomic<bool> m_mergeGeometries{ false };
+	std::atomic<bool> m_releaseModelData{ false };
+	std::atomic<bool> m_deferRelease{ true };
+	std::atomic<bool> m_tileBoundingVolumeCulling{ true };
+	std::atomic<unsigned int> m_maximumTextureSize{ 0 };
+
+	std::atomic<uint64_t> m_releasedModelBytes{ 0 };
+
+	czmosg::TextureCache m_textureCache;
+	czmosg::StateSetCache m_stateSetCache;
+	czmosg::DeferredReleaseQueue m_releaseQueue;
+	uint64_t m_releasedSincePrune = 0;
+	std::atomic<bool> m_stateSetCachePruneRequested{ false };
+
+	mutable std::mutex m_statisticsMutex;
+	czmosg::VertexCacheStatistics m_vertexCacheStatistics;
+	czmosg::GeometryMergeStatistics m_geometryMergeStatistics;
+	czmosg::NodeBuilderStatistics m_buildStatistics;
+	czmosg::NodeByteSize m_nodeByteSize;
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "StateSetCache.h"
+#include "Log.h"
+
+#include <functional>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		inline void hashCombine(size_t& seed, size_t value)
+		{
+			seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+		}
+	}
+
+	size_t MaterialKeyHash::operator()(const MaterialKey& key) const noexcept
+	{
+		size_t seed = std::hash<int>{}(key.kind);
+		for (int i = 0; i < 4; ++i) {
+			hashCombine(seed, std::hash<float>{}(key.baseColor[i]));
+		}
+		hashCombine(seed, std::hash<float>{}(key.metallic));
+		hashCombine(seed, std::hash<float>{}(key.roughness));
+		return seed;
+	}
+
+	size_t StateSetKeyHash::operator()(const StateSetKey& key) const noexcept
+	{
+		size_t seed = MaterialKeyHash{}(key.material);
+		hashCombine(seed, std::hash<const void*>{}(key.texture));
+		hashCombine(seed, std::hash<bool>{}(key.cullFace));
+		return seed;
+	}
+
+	osg::StateSet* StateSetCache::share(const StateSetKey& key, osg::StateSet* candidate)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_stateSets.find(key);
+		if (itr != m_stateSets.end()) {
+			++m_statistics.hits;
+			return itr->second.get();
+		}
+
+		++m_statistics.misses;
+
+		// 新登记的 StateSet 也尽量复用已有的材质（纹理不同、材质相同的情况）
+		if (key.material.kind != MaterialKey::NONE) {
+			const osg::StateSet::RefAttributePair* materialPair = candidate->getAttributePair(osg::StateAttribute::MATERIAL);
+			osg::Material* candidateMaterial = materialPair ? dynamic_cast<osg::Material*>(materialPair->first.get()) : nullptr;
+			if (candidateMaterial) {
+				auto materialItr = m_materials.find(key.material);
+				if (materialItr == m_materials.end()) {
+					m_materials.emplace(key.material, candidateMaterial);
+				}
+				else if (materialItr->second.get() != candidateMaterial) {
+					candidate->setAttribute(materialItr->second.get(), materialPair->second);
+				}
+			}
+		}
+
+		m_stateSets.emplace(key, candidate);
+		return candidate;
+	}
+
+	void StateSetCache::prune()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		size_t evicted = 0;
+
+		// 先淘汰 StateSet，它们释放后材质的引用计数才会降下来
+		for (auto itr = m_stateSets.begin(); itr != m_stateSets.end();) {
+			if (itr->second->referenceCount() <= 1) {
+				itr = m_stateSets.erase(itr);
+				++evicted;
+			}
+			else {
+				++itr;
+			}
+		}
+
+		for (auto itr = m_materials.begin(); itr != m_materials.end();) {
+			if (itr->second->referenceCount() <= 1) {
+				itr = m_materials.erase(itr);
+				++evicted;
+			}
+			else {
+				++itr;
+			}
+		}
+
+		if (evicted > 0) {
+			m_statistics.evicted += evicted;
+			CO_TRACE("StateSet cache evicted {} entries, {} state sets remaining", evicted, m_stateSets.size());
+		}
+	}
+
+	StateSetCache::Statistics StateSetCache::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Statistics statistics = m_statistics;
+		statistics.stateSets = m_stateSets.size();
+		statistics.materials = m_materials.size();
+		return statistics;
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <osg/Material>
+#include <osg/StateSet>
+#include <osg/Texture2D>
+#include <osg/Vec4>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 材质内容键：由 glTF PBR 参数决定生成的 osg::Material
+	 */
+	struct MaterialKey
+	{
+		enum Kind
+		{
+			NONE,			// 无材质（仅纹理）
+			PBR,			// 由 PBR 参数转换的材质（基础颜色按 sRGB 编码）
+			DEFAULT,		// 缺少材质时使用的默认材质（灰色，覆盖下层状态）
+			BASE_COLOR,		// 瓦片：线性基础颜色直接作为漫反射颜色
+			DEFAULT_WHITE	// 瓦片：缺少材质时使用的白色默认材质（不覆盖下层状态）
+		};
+
+		Kind kind = NONE;
+		osg::Vec4 baseColor = osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f);
+		float metallic = 0.0f;
+		float roughness = 1.0f;
+
+		bool operator==(const MaterialKey& other) const = default;
+	};
+
+	/**
+	 * @brief StateSet 内容键：材质 + 基础颜色纹理 + 背面剔除
+	 * 纹理按指针比较，开启跨瓦片纹理共享后相同内容的纹理指针相同。
+	 */
+	struct StateSetKey
+	{
+		MaterialKey material;
+		osg::Texture2D* texture = nullptr;
+		bool cullFace = false;
+
+		bool operator==(const StateSetKey& other) const = default;
+	};
+
+	struct MaterialKeyHash
+	{
+		size_t operator()(const MaterialKey& key) const noexcept;
+	};
+
+	struct StateSetKeyHash
+	{
+		size_t operator()(const StateSetKey& key) const noexcept;
+	};
+
+	/**
+	 * @brief 跨瓦片共享的 StateSet / 材质缓存（线程安全）
+	 * 内容相同的 StateSet 只保留一份，使 OSG 的状态图可以合并，减少每帧的状态切换。
+	 * 缓存持有强引用，每帧（有瓦片释放时）调用一次 prune() 淘汰不再被任何瓦片使用的条目。
+	 * StateSet 的父节点列表不是线程安全的，因此 share() 应在主线程中调用。
+	 */
+	class StateSetCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evicted = 0;
+			size_t stateSets = 0;
+			size_t materials = 0;
+		};
+
+		// 返回与 key 内容相同的共享 StateSet；不存在时将 candidate 登记为共享实例并返回它
+		osg::StateSet* share(const StateSetKey& key, osg::StateSet* candidate);
+
+		// 淘汰只被缓存自身引用的 StateSet 和材质
+		void prune();
+
+		Statistics getStatistics() const;
+
+	private:
+		mutable std::mutex m_mutex;
+		std::unordered_map<StateSetKey, osg::ref_ptr<osg::StateSet>, StateSetKeyHash> m_stateSets;
+		std::unordered_map<MaterialKey, osg::ref_ptr<osg::Material>, MaterialKeyHash> m_materials;
+		Statistics m_statistics;
+	};
+
+}	// namespace czmosg
@@ -0,0 +1,120 @@
+#include "TextureCache.h"
+#include "Log.h"
+
+#include <CesiumGltf/ImageAsset.h>
+
+#include <cstring>
+#include <functional>
+#include <string_view>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 每登记多少个新纹理清理一次失效条目
+		constexpr size_t PRUNE_INTERVAL = 64;
+
+		inline void hashCombine(size_t& seed, size_t value)
+		{
+			seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+		}
+	}
+
+	TextureCacheKey TextureCacheKey::create(const CesiumGltf::ImageAsset& image, const TextureSamplerState& sampler)
+	{
+		TextureCacheKey key;
+		std::string_view bytes(reinterpret_cast<const char*>(image.pixelData.data()), image.pixelData.size());
+		key.contentHash = std::hash<std::string_view>{}(bytes);
+		key.width = image.width;
+		key.height = image.height;
+		key.channels = image.channels;
+		key.sampler = sampler;
+		return key;
+	}
+
+	size_t TextureCacheKeyHash::operator()(const TextureCacheKey& key) const noexcept
+	{
+		size_t seed = static_cast<size_t>(key.contentHash);
+		hashCombine(seed, std::hash<int32_t>{}(key.width));
+		hashCombine(seed, std::hash<int32_t>{}(key.height));
+		hashCombine(seed, std::hash<int32_t>{}(key.channels));
+		hashCombine(seed, std::hash<int>{}(key.sampler.wrapS));
+		hashCombine(seed, std::hash<int>{}(key.sampler.wrapT));
+		hashCombine(seed, std::hash<int>{}(key.sampler.minFilter));
+		hashCombine(seed, std::hash<int>{}(key.sampler.magFilter));
+		return seed;
+	}
+
+	osg::ref_ptr<osg::Texture2D> TextureCache::find(const TextureCacheKey& key, std::span<const std::byte> pixels)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto itr = m_entries.find(key);
+		if (itr == m_entries.end()) {
+			++m_statistics.misses;
+			return nullptr;
+		}
+
+		osg::ref_ptr<osg::Texture2D> texture;
+		if (!itr->second.lock(texture)) {
+			m_entries.erase(itr);
+			++m_statistics.misses;
+			return nullptr;
+		}
+
+		// 图像数据仍在时逐字节校验，防止哈希冲突导致贴错纹理
+		const osg::Image* image = texture->getImage();
+		if (image && image->data()) {
+			if (image->getTotalSizeInBytes() != pixels.size() ||
+				std::memcmp(image->data(), pixels.data(), pixels.size()) != 0) {
+				CO_WARN("Texture cache hash collision detected, texture will not be shared");
+				++m_statistics.misses;
+				return nullptr;
+			}
+		}
+
+		++m_statistics.hits;
+		m_statistics.bytesSaved += pixels.size();
+		return texture;
+	}
+
+	void TextureCache::insert(const TextureCacheKey& key, osg::Texture2D* texture)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_entries[key] = texture;
+
+		if (++m_insertsSincePrune >= PRUNE_INTERVAL) {
+			pruneLocked();
+		}
+	}
+
+	void TextureCache::prune()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		pruneLocked();
+	}
+
+	void TextureCache::pruneLocked()
+	{
+		for (auto itr = m_entries.begin(); itr != m_entries.end();) {
+			if (!itr->second.valid()) {
+				itr = m_entries.erase(itr);
+			}
+			else {
+				++itr;
+			}
+		}
+		m_insertsSincePrune = 0;
+	}
+
+	TextureCache::Statistics TextureCache::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Statistics statistics = m_statistics;
+		statistics.entries = m_entries.size();
+		return statistics;
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <osg/Texture2D>
+#include <osg/observer_ptr>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace CesiumGltf {
+	struct ImageAsset;
+}
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 纹理的采样状态（对应 glTF sampler，已转换为 OSG 枚举）
+	 */
+	struct TextureSamplerState
+	{
+		osg::Texture::WrapMode wrapS = osg::Texture::REPEAT;
+		osg::Texture::WrapMode wrapT = osg::Texture::REPEAT;
+		osg::Texture::FilterMode minFilter = osg::Texture::LINEAR_MIPMAP_LINEAR;
+		osg::Texture::FilterMode magFilter = osg::Texture::LINEAR;
+
+		bool operator==(const TextureSamplerState& other) const = default;
+	};
+
+	/**
+	 * @brief 跨瓦片纹理缓存的键：像素内容哈希 + 图像尺寸/格式 + 采样状态
+	 */
+	struct TextureCacheKey
+	{
+		uint64_t contentHash = 0;
+		int32_t width = 0;
+		int32_t height = 0;
+		int32_t channels = 0;
+		TextureSamplerState sampler;
+
+		bool operator==(const TextureCacheKey& other) const = default;
+
+		static TextureCacheKey create(const CesiumGltf::ImageAsset& image, const TextureSamplerState& sampler);
+	};
+
+	struct TextureCacheKeyHash
+	{
+		size_t operator()(const TextureCacheKey& key) const noexcept;
+	};
+
+	/**
+	 * @brief 跨瓦片共享的纹理缓存（线程安全）
+	 * 只弱引用缓存的纹理，所有瓦片释放后条目自动失效，不会延长纹理的生命周期。
+	 */
+	class TextureCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t bytesSaved = 0;
+			size_t entries = 0;
+		};
+
+		// 查找内容相同的纹理；pixels 用于在命中时校验内容，防止哈希冲突
+		osg::ref_ptr<osg::Texture2D> find(const TextureCacheKey& key, std::span<const std::byte> pixels);
+
+		// 登记新创建的纹理
+		void insert(const TextureCacheKey& key, osg::Texture2D* texture);
+
+		// 清理已失效（纹理已被释放）的条目
+		void prune();
+
+		Statistics getStatistics() const;
+
+	private:
+		void pruneLocked();
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<TextureCacheKey, osg::observer_ptr<osg::Texture2D>, TextureCacheKeyHash> m_entries;
+		Statistics m_statistics;
+		size_t m_insertsSincePrune = 0;
+	};
+
+}	// namespace czmosg
@@ -0,0 +1,393 @@
+#include "TileBatcher.h"
+#include "MemoryUsage.h"
+#include "MeshOptimizer.h"
+#include "TileCulling.h"
+#include "Log.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/NodeVisitor>
+
+#include <exception>
+#include <set>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		// 失效批次在不可见多少帧后被丢弃
+		constexpr unsigned int EVICT_FRAMES = 120;
+
+		// 只复制顶点数据和图元，不经过 osg::Geometry 的拷贝构造（它会把 StateSet 挂接到副本上）
+		osg::ref_ptr<osg::Geometry> copyGeometryData(const osg::Geometry& source)
+		{
+			if (!source.getVertexArray() || source.getColorArray() || source.getSecondaryColorArray() ||
+				source.getFogCoordArray() || source.getNumVertexAttribArrays() > 0 || source.getNumTexCoordArrays() > 1) {
+				return nullptr;
+			}
+
+			osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+			geometry->setUseDisplayList(false);
+			geometry->setUseVertexBufferObjects(true);
+			geometry->setVertexArray(osg::clone(source.getVertexArray(), osg::CopyOp::DEEP_COPY_ALL));
+			if (source.getNormalArray()) {
+				geometry->setNormalArray(osg::clone(source.getNormalArray(), osg::CopyOp::DEEP_COPY_ALL));
+			}
+			if (source.getTexCoordArray(0)) {
+				geometry->setTexCoordArray(0, osg::clone(source.getTexCoordArray(0), osg::CopyOp::DEEP_COPY_ALL));
+			}
+			for (unsigned int i = 0; i < source.getNumPrimitiveSets(); ++i) {
+				geometry->addPrimitiveSet(osg::clone(source.getPrimitiveSet(i), osg::CopyOp::DEEP_COPY_ALL));
+			}
+			return geometry;
+		}
+
+		// 复制瓦片中的几何体，预乘其相对于批次参考点的变换，StateSet 替换为占位对象
+		class BatchCollectVisitor : public osg::NodeVisitor
+		{
+		public:
+			BatchCollectVisitor(osg::Geode* output, std::map<osg::StateSet*, osg::ref_ptr<osg::StateSet>>& stateSets)
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+				, m_output(output)
+				, m_stateSets(stateSets)
+			{
+				m_matrixStack.push_back(osg::Matrixd::identity());
+			}
+
+			// 参考点取第一个几何体所在坐标系的原点，批次内坐标保持较小以避免 float 精度损失
+			bool hasReference() const { return m_hasReference; }
+			const osg::Matrixd& getReference() const { return m_reference; }
+
+			void apply(osg::Transform& transform) override
+			{
+				osg::Matrixd matrix = m_matrixStack.back();
+				transform.computeLocalToWorldMatrix(matrix, this);
+				m_matrixStack.push_back(matrix);
+				traverse(transform);
+				m_matrixStack.pop_back();
+			}
+
+			void apply(osg::Geode& geode) override
+			{
+				for (unsigned int i = 0; i < geode.getNumDrawables(); ++i) {
+					const osg::Geometry* source = geode.getDrawable(i)->asGeometry();
+					if (!source) {
+						failed = true;
+						continue;
+					}
+
+					// Geode 与几何体同时带 StateSet 时无法用单个 StateSet 表达
+					if (source->getStateSet() && geode.getStateSet()) {
+						failed = true;
+						continue;
+					}
+
+					if (!m_hasReference) {
+						m_reference = osg::Matrixd::translate(m_matrixStack.back().getTrans());
+						m_inverseReference = osg::Matrixd::inverse(m_reference);
+						m_hasReference = true;
+					}
+
+					osg::ref_ptr<osg::Geometry> geometry = copyGeometryData(*source);
+					if (!geometry.valid()) {
+						failed = true;
+						continue;
+					}
+
+					const osg::Matrixd matrix = m_matrixStack.back() * m_inverseReference;
+					if (!matrix.isIdentity() && !transformGeometry(*geometry, matrix)) {
+						failed = true;
+						continue;
+					}
+
+					const osg::StateSet* stateSet = source->getStateSet() ? source->getStateSet() : geode.getStateSet();
+					if (stateSet) {
+						geometry->setStateSet(getPlaceholder(const_cast<osg::StateSet*>(stateSet)));
+					}
+					m_output->addDrawable(geometry.get());
+				}
+			}
+
+			bool failed = false;
+
+		private:
+			osg::StateSet* getPlaceholder(osg::StateSet* stateSet)
+			{
+				auto itr = m_placeholders.find(stateSet);
+				if (itr != m_placeholders.end()) {
+					return itr->second;
+				}
+				osg::ref_ptr<osg::StateSet> placeholder = new osg::StateSet;
+				m_stateSets.emplace(placeholder.get(), stateSet);
+				m_placeholders.emplace(stateSet, placeholder.get());
+				return placeholder.get();
+			}
+
+			osg::Geode* m_output;
+			std::map<osg::StateSet*, osg::ref_ptr<osg::StateSet>>& m_stateSets;
+			std::map<osg::StateSet*, osg::StateSet*> m_placeholders;
+			std::vector<osg::Matrixd> m_matrixStack;
+			osg::Matrixd m_reference;
+			osg::Matrixd m_inverseReference;
+			bool m_hasReference = false;
+		};
+
+		// 把批次中的占位 StateSet 替换为真实的 StateSet
+		class ReplaceStateSetVisitor : public osg::NodeVisitor
+		{
+		public:
+			explicit ReplaceStateSetVisitor(const std::map<osg::StateSet*, osg::ref_ptr<osg::StateSet>>& stateSets)
+				: osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+				, m_stateSets(stateSets)
+			{
+			}
+
+			void apply(osg::Drawable& drawable) override
+			{
+				auto itr = m_stateSets.find(drawable.getStateSet());
+				if (itr != m_stateSets.end()) {
+					drawable.setStateSet(itr->second.get());
+				}
+			}
+
+		private:
+			const std::map<osg::StateSet*, osg::ref_ptr<osg::StateSet>>& m_stateSets;
+		};
+	}
+
+	TileBatcher::TileBatcher()
+	{
+		m_workerThread = std::thread(&TileBatcher::workerThreadFunction, this);
+	}
+
+	TileBatcher::~TileBatcher()
+	{
+		m_shutdown = true;
+		m_condition.notify_all();
+
+		if (m_workerThread.joinable()) {
+			m_workerThread.join();
+		}
+	}
+
+	void TileBatcher::update(const std::vector<SiblingTileGroup>& groups, std::vector<osg::Node*>& nodesToRender)
+	{
+		installResults();
+
+		++m_frame;
+		unsigned int tilesBatched = 0;
+		unsigned int batchesRendered = 0;
+
+		for (const SiblingTileGroup& group : groups) {
+			if (group.nodes.size() < 2) {
+				nodesToRender.insert(nodesToRender.end(), group.nodes.begin(), group.nodes.end());
+				continue;
+			}
+
+			Entry& entry = m_entries[group.parent];
+			entry.lastUsed = m_frame;
+
+			// 可见的兄弟集合发生变化：批次失效，重新开始计算稳定帧数
+			if (!sameMembers(entry.members, group.nodes)) {
+				if (entry.batch.valid() || entry.pending) {
+					std::lock_guard<std::mutex> lock(m_statisticsMutex);
+					++m_statistics.batchesDiscarded;
+				}
+				entry.members.assign(group.nodes.begin(), group.nodes.end());
+				entry.batch = nullptr;
+				entry.batchBytes = 0;
+				entry.pending = false;
+				entry.generation = m_nextGeneration++;
+				entry.stableSince = m_frame;
+			}
+
+			if (entry.batch.valid()) {
+				nodesToRender.push_back(entry.batch.get());
+				tilesBatched += static_cast<unsigned int>(group.nodes.size());
+				++batchesRendered;
+				continue;
+			}
+
+			nodesToRender.insert(nodesToRender.end(), group.nodes.begin(), group.nodes.end());
+
+			if (!entry.pending && m_frame - entry.stableSince >= m_stableFrames) {
+				Job job;
+				job.parent = group.parent;
+				job.generation = entry.generation;
+				job.members = entry.members;
+				{
+					std::lock_guard<std::mutex> lock(m_queueMutex);
+					m_jobs.push_back(std::move(job));
+				}
+				m_condition.notify_one();
+				entry.pending = true;
+			}
+		}
+
+		// 丢弃长时间不可见的分组，释放其持有的瓦片节点和批次
+		for (auto itr = m_entries.begin(); itr != m_entries.end();) {
+			if (m_frame - itr->second.lastUsed > EVICT_FRAMES) {
+				itr = m_entries.erase(itr);
+			}
+			else {
+				++itr;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		m_statistics.tilesBatched = tilesBatched;
+		m_statistics.batchesRendered = batchesRendered;
+	}
+
+	void TileBatcher::clear()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_jobs.clear();
+			m_results.clear();
+		}
+		m_entries.clear();
+	}
+
+	TileBatcher::Statistics TileBatcher::getStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		Statistics statistics = m_statistics;
+		statistics.batches = 0;
+		for (const auto& [parent, entry] : m_entries) {
+			if (entry.batch.valid()) {
+				++statistics.batches;
+				statistics.batchBytes += entry.batchBytes;
+			}
+		}
+		return statistics;
+	}
+
+	uint64_t TileBatcher::getBatchBytes() const
+	{
+		uint64_t bytes = 0;
+		for (const auto& [parent, entry] : m_entries) {
+			if (entry.batch.valid()) {
+				bytes += entry.batchBytes;
+			}
+		}
+		return bytes;
+	}
+
+	bool TileBatcher::sameMembers(const std::vector<osg::ref_ptr<osg::Node>>& members, const std::vector<osg::Node*>& nodes)
+	{
+		if (members.size() != nodes.size()) {
+			return false;
+		}
+		for (size_t i = 0; i < nodes.size(); ++i) {
+			if (members[i].get() != nodes[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void TileBatcher::installResults()
+	{
+		std::vector<Result> results;
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			results.swap(m_results);
+		}
+
+		for (Result& result : results) {
+			auto itr = m_entries.find(result.parent);
+			if (itr == m_entries.end() || itr->second.generation != result.generation) {
+				continue;
+			}
+
+			Entry& entry = itr->second;
+			entry.pending = false;
+			if (!result.batch.valid()) {
+				// 构建失败（几何体无法合并），保持逐瓦片渲染，直到集合变化后再尝试
+				entry.pending = true;
+				continue;
+			}
+
+			// StateSet 的父节点列表不是线程安全的，在主线程中挂接真实的 StateSet
+			ReplaceStateSetVisitor visitor(result.stateSets);
+			result.batch->accept(visitor);
+
+			// 批次代替成员瓦片参与裁剪，使用成员包围体的并集
+			setBatchBoundingVolume(result.batch.get(), entry.members);
+
+			entry.batch = result.batch;
+			entry.batchBytes = result.batchBytes;
+
+			std::lock_guard<std::mutex> lock(m_statisticsMutex);
+			++m_statistics.batchesBuilt;
+		}
+	}
+
+	TileBatcher::Result TileBatcher::buildBatch(const Job& job)
+	{
+		Result result;
+		result.parent = job.parent;
+		result.generation = job.generation;
+
+		osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+		BatchCollectVisitor collector(geode.get(), result.stateSets);
+		for (const auto& member : job.members) {
+			member->accept(collector);
+		}
+
+		if (collector.failed || !collector.hasReference()) {
+			CO_DEBUG("Tile batch skipped: {} tiles contain geometry that cannot be batched", job.members.size());
+			result.stateSets.clear();
+			return result;
+		}
+
+		osg::ref_ptr<osg::MatrixTransform> batch = new osg::MatrixTransform(collector.getReference());
+		batch->addChild(geode.get());
+
+		GeometryMergeStatistics statistics = mergeGeometries(batch.get());
+		CO_DEBUG("Built tile batch from {} tiles: {} -> {} geometries",
+			job.members.size(), statistics.geometriesBefore, statistics.geometriesAfter);
+
+		// 统计批次复制的几何体；StateSet 与成员瓦片共享，不计入
+		std::set<const osg::Referenced*> excluded;
+		for (const auto& [placeholder, stateSet] : result.stateSets) {
+			excluded.insert(placeholder);
+		}
+		result.batchBytes = computeNodeByteSize(batch.get(), &excluded).total();
+
+		result.batch = batch;
+		return result;
+	}
+
+	void TileBatcher::workerThreadFunction()
+	{
+		while (!m_shutdown) {
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_queueMutex);
+				m_condition.wait(lock, [this] { return m_shutdown || !m_jobs.empty(); });
+
+				if (m_shutdown) {
+					break;
+				}
+
+				job = std::move(m_jobs.front());
+				m_jobs.pop_front();
+			}
+
+			try {
+				Result result = buildBatch(job);
+				std::lock_guard<std::mutex> lock(m_queueMutex);
+				m_results.push_back(std::move(result));
+			}
+			catch (const std::exception& e) {
+				CO_ERROR("Tile batch build failed: {}", e.what());
+			}
+		}
+	}
+
+}	// namespace czmosg
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <osg/Node>
+#include <osg/StateSet>
+#include <osg/ref_ptr>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 同一父瓦片下、同一帧可见的兄弟瓦片节点
+	 */
+	struct SiblingTileGroup
+	{
+		const void* parent = nullptr;
+		std::vector<osg::Node*> nodes;
+	};
+
+	/**
+	 * @brief 跨瓦片批处理：把持续稳定可见的兄弟瓦片合并为一个批次节点
+	 * 兄弟瓦片集合连续若干帧不变后，在后台线程中复制其几何体、统一到同一局部坐标系，
+	 * 并按 StateSet 合并（见 mergeGeometries），之后以批次节点代替各瓦片节点参与渲染。
+	 * 可见集合变化时批次立即失效，回退为逐瓦片渲染，待重新稳定后再后台重建。
+	 * 瓦片之间共享 StateSet（setShareStateSetsAcrossTiles）时合并效果最好。
+	 * update() 只能在主线程中调用。
+	 */
+	class TileBatcher
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t batchesBuilt = 0;
+			uint64_t batchesDiscarded = 0;
+			size_t batches = 0;
+			// 最近一帧由批次节点代替的瓦片数和使用的批次数
+			unsigned int tilesBatched = 0;
+			unsigned int batchesRendered = 0;
+			// 批次复制的几何体占用的字节数（成员瓦片仍然保留，这部分是额外的占用）
+			uint64_t batchBytes = 0;
+		};
+
+		TileBatcher();
+		~TileBatcher();
+
+		// 设置兄弟瓦片集合需要保持不变多少帧才开始构建批次
+		void setStableFrames(unsigned int frames) { m_stableFrames = frames; }
+		unsigned int getStableFrames() const { return m_stableFrames; }
+
+		// 每帧调用：根据本帧可见的兄弟瓦片分组，输出应加入场景图的节点（批次节点或原瓦片节点）
+		void update(const std::vector<SiblingTileGroup>& groups, std::vector<osg::Node*>& nodesToRender);
+
+		// 丢弃所有批次（例如关闭批处理时）
+		void clear();
+
+		Statistics getStatistics() const;
+
+		// 获取当前所有批次占用的字节数，只能在主线程中调用
+		uint64_t getBatchBytes() const;
+
+	private:
+		struct Entry
+		{
+			std::vector<osg::ref_ptr<osg::Node>> members;
+			osg::ref_ptr<osg::Node> batch;
+			uint64_t batchBytes = 0;
+			uint64_t generation = 0;
+			unsigned int stableSince = 0;
+			unsigned int lastUsed = 0;
+			bool pending = false;
+		};
+
+		struct Job
+		{
+			const void* parent = nullptr;
+			uint64_t generation = 0;
+			std::vector<osg::ref_ptr<osg::Node>> members;
+		};
+
+		struct Result
+		{
+			const void* parent = nullptr;
+			uint64_t generation = 0;
+			osg::ref_ptr<osg::Node> batch;
+			uint64_t batchBytes = 0;
+			// 后台线程使用占位 StateSet，安装时在主线程替换为真实的 StateSet
+			std::map<osg::StateSet*, osg::ref_ptr<osg::StateSet>> stateSets;
+		};
+
+		static bool sameMembers(const std::vector<osg::ref_ptr<osg::Node>>& members, const std::vector<osg::Node*>& nodes);
+
+		static Result buildBatch(const Job& job);
+
+		void installResults();
+
+		void workerThreadFunction();
+
+		unsigned int m_stableFrames = 30;
+		unsigned int m_frame = 0;
+		uint64_t m_nextGeneration = 1;
+		std::unordered_map<const void*, Entry> m_entries;
+
+		std::atomic<bool> m_shutdown{ false };
+		std::thread m_workerThread;
+		std::mutex m_queueMutex;
+		std::condition_variable m_condition;
+		std::deque<Job> m_jobs;
+		std::vector<Result> m_results;
+
+		mutable std::mutex m_statisticsMutex;
+		Statistics m_statistics;
+	};
+
+}	// namespace czmosg
@@ -0,0 +1,157 @@
+#include "TileCulling.h"
+
+#include <CesiumGeometry/OrientedBoundingBox.h>
+
+#include <osgUtil/CullVisitor>
+
+#include <algorithm>
+#include <cmath>
+
+namespace czmosg
+{
+
+	namespace
+	{
+		/**
+		 * @brief 返回固定包围球的回调，节点的包围球不再从几何体计算
+		 * osg::BoundingSphere 以 float 存储，地心坐标下中心的舍入误差约为半米，半径按中心的量级放大以覆盖误差。
+		 */
+		class TileBoundCallback : public osg::Node::ComputeBoundingSphereCallback
+		{
+		public:
+			explicit TileBoundCallback(const osg::BoundingSphered& sphere)
+				: m_boundingSphere(sphere)
+			{
+				const double precision = sphere.center().length() * 1e-6;
+				m_boundingSphere.radius() += precision;
+			}
+
+			virtual osg::BoundingSphere computeBound(const osg::Node&) const override
+			{
+				return osg::BoundingSphere(osg::Vec3(m_boundingSphere.center()), m_boundingSphere.radius());
+			}
+
+		protected:
+			virtual ~TileBoundCallback() = default;
+
+		private:
+			osg::BoundingSphered m_boundingSphere;
+		};
+
+		// 在节点的裁剪回调链中查找瓦片裁剪回调
+		TileCullCallback* findTileCullCallback(osg::Node* node)
+		{
+			for (osg::Callback* callback = node->getCullCallback(); callback; callback = callback->getNestedCallback()) {
+				if (TileCullCallback* tileCallback = dynamic_cast<TileCullCallback*>(callback)) {
+					return tileCallback;
+				}
+			}
+			return nullptr;
+		}
+	}
+
+	TileCullCallback::TileCullCallback(const osg::Vec3d& center, const osg::Vec3d& xAxis, const osg::Vec3d& yAxis, const osg::Vec3d& zAxis)
+		: m_center(center)
+		, m_halfAxes{ xAxis, yAxis, zAxis }
+		// 半轴两两正交，外接球半径为半对角线长
+		, m_boundingSphere(center, std::sqrt(xAxis.length2() + yAxis.length2() + zAxis.length2()))
+	{
+	}
+
+	bool TileCullCallback::isCulled(const osg::Polytope& frustum) const
+	{
+		for (const osg::Plane& plane : frustum.getPlaneList()) {
+			// 包围盒在平面法线上的投影半径
+			const osg::Vec3d normal = plane.getNormal();
+			const double radius = std::abs(normal * m_halfAxes[0]) + std::abs(normal * m_halfAxes[1]) + std::abs(normal * m_halfAxes[2]);
+			if (plane.distance(m_center) < -radius) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TileCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
+	{
+		osgUtil::CullVisitor* cv = nv->asCullVisitor();
+		if (cv && (cv->getCullingMode() & osg::CullSettings::VIEW_FRUSTUM_CULLING) &&
+			isCulled(cv->getCurrentCullingSet().getFrustum())) {
+			return;
+		}
+		traverse(node, nv);
+	}
+
+	BatchCullCallback::BatchCullCallback(std::vector<osg::ref_ptr<TileCullCallback>> members)
+		: m_members(std::move(members))
+	{
+	}
+
+	void BatchCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
+	{
+		osgUtil::CullVisitor* cv = nv->asCullVisitor();
+		if (cv && (cv->getCullingMode() & osg::CullSettings::VIEW_FRUSTUM_CULLING)) {
+			const osg::Polytope& frustum = cv->getCurrentCullingSet().getFrustum();
+			const bool culled = std::all_of(m_members.begin(), m_members.end(),
+				[&frustum](const osg::ref_ptr<TileCullCallback>& member) { return member->isCulled(frustum); });
+			if (culled) {
+				return;
+			}
+		}
+		traverse(node, nv);
+	}
+
+	void setTileBoundingVolume(osg::Node* node, const Cesium3DTilesSelection::BoundingVolume& boundingVolume)
+	{
+		if (!node) {
+			return;
+		}
+
+		const CesiumGeometry::OrientedBoundingBox box = Cesium3DTilesSelection::getOrientedBoundingBoxFromBoundingVolume(boundingVolume);
+		const glm::dvec3& center = box.getCenter();
+		const glm::dmat3& halfAxes = box.getHalfAxes();
+
+		osg::ref_ptr<TileCullCallback> cullCallback = new TileCullCallback(
+			osg::Vec3d(center.x, center.y, center.z),
+			osg::Vec3d(halfAxes[0].x, halfAxes[0].y, halfAxes[0].z),
+			osg::Vec3d(halfAxes[1].x, halfAxes[1].y, halfAxes[1].z),
+			osg::Vec3d(halfAxes[2].x, halfAxes[2].y, halfAxes[2].z));
+
+		node->setComputeBoundingSphereCallback(new TileBoundCallback(cullCallback->getBoundingSphere()));
+		node->dirtyBound();
+		node->addCullCallback(cullCallback.get());
+	}
+
+	void setBatchBoundingVolume(osg::Node* batch, const std::vector<osg::ref_ptr<osg::Node>>& members)
+	{
+		if (!batch || members.empty()) {
+			return;
+		}
+
+		osg::BoundingSphered sphere;
+		std::vector<osg::ref_ptr<TileCullCallback>> cullCallbacks;
+		bool allCulled = true;
+		for (const osg::ref_ptr<osg::Node>& member : members) {
+			TileCullCallback* cullCallback = findTileCullCallback(member.get());
+			if (cullCallback) {
+				sphere.expandBy(cullCallback->getBoundingSphere());
+				cullCallbacks.push_back(cullCallback);
+			}
+			else {
+				const osg::BoundingSphere& bound = member->getBound();
+				if (bound.valid()) {
+					sphere.expandBy(osg::BoundingSphered(osg::Vec3d(bound.center()), bound.radius()));
+				}
+				allCulled = false;
+			}
+		}
+
+		if (sphere.valid()) {
+			batch->setComputeBoundingSphereCallback(new TileBoundCallback(sphere));
+			batch->dirtyBound();
+		}
+		if (allCulled) {
+			batch->addCullCallback(new BatchCullCallback(std::move(cullCallbacks)));
+		}
+	}
+
+}	// namespace czmosg
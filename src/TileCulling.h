@@ -0,0 +1,77 @@
+#pragma once
+
+#include <Cesium3DTilesSelection/BoundingVolume.h>
+
+#include <osg/BoundingSphere>
+#include <osg/Node>
+#include <osg/NodeCallback>
+#include <osg/Polytope>
+#include <osg/Vec3d>
+#include <osg/ref_ptr>
+
+#include <vector>
+
+namespace czmosg
+{
+
+	/**
+	 * @brief 按瓦片的有向包围盒剔除瓦片节点的裁剪回调
+	 * 包围盒来自 cesium-native 的瓦片包围体（region、球等都转换为有向包围盒），与节点几何体在同一坐标系（地心坐标）。
+	 * 对当前视锥体的每个平面只做一次点积测试，不在视锥体内时不再进入瓦片的几何体，
+	 * 包围盒比按几何体计算的包围球更紧，也能剔除 cesium-native 为其它视图保留、而当前相机（如视锥更窄的从相机）看不到的瓦片。
+	 */
+	class TileCullCallback : public osg::NodeCallback
+	{
+	public:
+		TileCullCallback(const osg::Vec3d& center, const osg::Vec3d& xAxis, const osg::Vec3d& yAxis, const osg::Vec3d& zAxis);
+
+		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv) override;
+
+		// 包围盒是否完全在视锥体的某个平面之外
+		bool isCulled(const osg::Polytope& frustum) const;
+
+		// 包围盒的外接球
+		const osg::BoundingSphered& getBoundingSphere() const { return m_boundingSphere; }
+
+	protected:
+		virtual ~TileCullCallback() = default;
+
+	private:
+		osg::Vec3d m_center;
+		// 三个半轴（方向乘以半长）
+		osg::Vec3d m_halfAxes[3];
+		osg::BoundingSphered m_boundingSphere;
+	};
+
+	/**
+	 * @brief 按多个瓦片的包围盒剔除批次节点的裁剪回调
+	 * 所有成员瓦片的包围盒都在视锥体之外时才剔除整个批次。
+	 */
+	class BatchCullCallback : public osg::NodeCallback
+	{
+	public:
+		explicit BatchCullCallback(std::vector<osg::ref_ptr<TileCullCallback>> members);
+
+		virtual void operator()(osg::Node* node, osg::NodeVisitor* nv) override;
+
+	protected:
+		virtual ~BatchCullCallback() = default;
+
+	private:
+		std::vector<osg::ref_ptr<TileCullCallback>> m_members;
+	};
+
+	/**
+	 * @brief 为瓦片节点安装按包围体剔除的裁剪回调，并用包围体的外接球作为节点的包围球
+	 * 节点的包围球不再由几何体计算，OSG 的包围球剔除和父节点的包围球都不需要遍历瓦片的几何体。
+	 */
+	void setTileBoundingVolume(osg::Node* node, const Cesium3DTilesSelection::BoundingVolume& boundingVolume);
+
+	/**
+	 * @brief 为代替多个瓦片节点的批次节点设置包围体：包围球为各成员包围球的并集，
+	 * 所有成员都安装了瓦片裁剪回调（setTileBoundingVolume）时再按成员的包围盒剔除批次。
+	 * 成员节点的包围球可能需要计算，应在主线程中调用。
+	 */
+	void setBatchBoundingVolume(osg::Node* batch, const std::vector<osg::ref_ptr<osg::Node>>& members);
+
+}	// namespace czmosg
@@ -15,6 +15,9 @@
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
 
 //// 判断文件名是否以指定后缀（不区分大小写）结尾
 //static bool hasFileExtension(const std::string& filename, const std::string& ext)
@@ -107,8 +110,10 @@ static void zoomToModel(osgViewer::Viewer* viewer, osg::Node* model)
     {
         // 更精确：从当前相机投影矩阵提取 FOV
         double fovy, aspectRatio, zNear, zFar;
-        viewer->getCamera()->getProjectionMatrix().getPerspective(fovy, aspectRatio, zNear, zFar);
-        fov = osg::DegreesToRadians(fovy);
+        // 正交投影没有视场角，保持默认值
+        if (viewer->getCamera()->getProjectionMatrix().getPerspective(fovy, aspectRatio, zNear, zFar)) {
+            fov = osg::DegreesToRadians(fovy);
+        }
     }
 
     // 距离 = 半径 / sin(fov/2)  —— 保证包围球刚好填满视口垂直方向
@@ -122,12 +127,110 @@ static void zoomToModel(osgViewer::Viewer* viewer, osg::Node* model)
     manipulator->home(0.0); // 0.0 表示不带动画，立即跳转
 }
 
+/**
+ * @brief 离屏回放相机路径，统计瓦片加载是否跟得上相机，用于比较开启/关闭预测预取的效果
+ *
+ * 路径文件每行一个关键帧：time eyeX eyeY eyeZ centerX centerY centerZ upX upY upZ（地心坐标），
+ * 关键帧之间线性插值，以固定 60 帧/秒的仿真时间推进。
+ * 输出平均加载队列长度、加载队列非空的帧比例和预取命中率。
+ */
+static int runCameraPathBenchmark(const std::string& tilesetUrl, const std::string& pathFile, bool prefetch)
+{
+    struct Keyframe
+    {
+        double time;
+        osg::Vec3d eye, center, up;
+    };
+
+    std::vector<Keyframe> keyframes;
+    std::ifstream stream(pathFile);
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::istringstream lineStream(line);
+        Keyframe keyframe;
+        if (lineStream >> keyframe.time
+            >> keyframe.eye.x() >> keyframe.eye.y() >> keyframe.eye.z()
+            >> keyframe.center.x() >> keyframe.center.y() >> keyframe.center.z()
+            >> keyframe.up.x() >> keyframe.up.y() >> keyframe.up.z()) {
+            keyframes.push_back(keyframe);
+        }
+    }
+    if (keyframes.size() < 2) {
+        CO_ERROR("Camera path {} needs at least two keyframes", pathFile);
+        return 1;
+    }
+
+    const int width = 1280;
+    const int height = 720;
+    osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+    traits->width = width;
+    traits->height = height;
+    traits->pbuffer = true;
+    traits->doubleBuffer = false;
+    osg::ref_ptr<osg::GraphicsContext> context = osg::GraphicsContext::createGraphicsContext(traits.get());
+    if (!context.valid()) {
+        CO_ERROR("Failed to create an off-screen graphics context");
+        return 1;
+    }
+
+    osg::ref_ptr<Cesium3DTileset> tileset = new Cesium3DTileset(tilesetUrl);
+    tileset->setPredictivePrefetch(prefetch);
+
+    osgViewer::Viewer viewer;
+    viewer.setThreadingModel(osgViewer::Viewer::SingleThreaded);
+    viewer.getCamera()->setGraphicsContext(context.get());
+    viewer.getCamera()->setViewport(0, 0, width, height);
+    viewer.getCamera()->setProjectionMatrixAsPerspective(60.0, double(width) / height, 1.0, 1e7);
+    viewer.getCamera()->setComputeNearFarMode(osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR);
+    viewer.setSceneData(tileset.get());
+    viewer.realize();
+
+    const double frameInterval = 1.0 / 60.0;
+    const double duration = keyframes.back().time;
+    size_t segment = 0;
+    uint64_t frames = 0;
+    uint64_t framesWithQueuedLoads = 0;
+    uint64_t queuedLoads = 0;
+    for (double time = keyframes.front().time; time <= duration; time += frameInterval) {
+        while (segment + 2 < keyframes.size() && keyframes[segment + 1].time < time) {
+            ++segment;
+        }
+        const Keyframe& from = keyframes[segment];
+        const Keyframe& to = keyframes[segment + 1];
+        const double t = to.time > from.time ? std::clamp((time - from.time) / (to.time - from.time), 0.0, 1.0) : 1.0;
+        viewer.getCamera()->setViewMatrixAsLookAt(
+            from.eye + (to.eye - from.eye) * t,
+            from.center + (to.center - from.center) * t,
+            from.up + (to.up - from.up) * t);
+
+        viewer.frame(time);
+
+        const uint32_t queueLength = tileset->getLoadQueueLength();
+        queuedLoads += queueLength;
+        framesWithQueuedLoads += queueLength > 0 ? 1 : 0;
+        ++frames;
+    }
+
+    const Cesium3DTileset::PrefetchStatistics statistics = tileset->getPrefetchStatistics();
+    CO_INFO("Camera path benchmark ({}): {} frames, {:.2f} queued loads per frame, {:.1f}% frames waiting for tiles",
+        prefetch ? "prefetch" : "no prefetch", frames, frames > 0 ? double(queuedLoads) / frames : 0.0,
+        frames > 0 ? 100.0 * framesWithQueuedLoads / frames : 0.0);
+    CO_INFO("Prefetch: {} predicted views, {} of {} tiles already loaded when they became visible ({:.1f}%)",
+        statistics.predictedViews, statistics.prefetchHits, statistics.tilesEntered, statistics.hitRate() * 100.0);
+    return 0;
+}
+
 int main(int argc, char** argv)
 {
     // 需要显式创建并持有，以控制生命周期
     // 初始化日志系统
     czmosg::initializeLogger();
 
+    // 离屏回放相机路径：CesiumOsg --camera-path <tileset.json> <path.txt> [--prefetch]
+    if (argc >= 4 && std::string(argv[1]) == "--camera-path") {
+        return runCameraPathBenchmark(argv[2], argv[3], argc >= 5 && std::string(argv[4]) == "--prefetch");
+    }
+
     // 创建根节点
     osg::ref_ptr<osg::Group> root = new osg::Group();
 
@@ -0,0 +1,174 @@
+#include "TestCheck.h"
+
+#include "CacheBudgetManager.h"
+#include "Log.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr int64_t MB = 1024 * 1024;
+
+	struct Notification
+	{
+		std::string tileset;
+		int64_t budget = 0;
+		bool updated = false;
+	};
+
+	// 模拟的瓦片集：记录收到的回调
+	struct TestTileset
+	{
+		std::string name;
+		std::vector<Notification>* log = nullptr;
+
+		void add(czmosg::CacheBudgetManager& manager)
+		{
+			manager.addTileset(this, [this](int64_t budget, bool updated) {
+				log->push_back({ name, budget, updated });
+			});
+		}
+	};
+
+	size_t countNotifications(const std::vector<Notification>& log, const std::string& tileset)
+	{
+		size_t count = 0;
+		for (const Notification& notification : log) {
+			if (notification.tileset == tileset) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	void testSplitByContribution()
+	{
+		std::vector<Notification> log;
+		czmosg::CacheBudgetManager manager(1000 * MB);
+		manager.setMinimumBytes(0);
+
+		TestTileset a{ "a", &log };
+		TestTileset b{ "b", &log };
+		a.add(manager);
+		b.add(manager);
+
+		// 两个瓦片集的需要都超过总预算，按贡献 3:1 分配
+		for (unsigned int frame = 1; frame <= 2; ++frame) {
+			manager.update(&a, frame, 0.75, 4000 * MB);
+			manager.update(&b, frame, 0.25, 4000 * MB);
+		}
+
+		CHECK(manager.getBudget(&a).budget == 750 * MB);
+		CHECK(manager.getBudget(&b).budget == 250 * MB);
+		CHECK(manager.getUsedBytes() == 8000 * MB);
+	}
+
+	void testRedistributeLeftover()
+	{
+		std::vector<Notification> log;
+		czmosg::CacheBudgetManager manager(1000 * MB);
+		manager.setMinimumBytes(0);
+
+		TestTileset a{ "a", &log };
+		TestTileset b{ "b", &log };
+		a.add(manager);
+		b.add(manager);
+
+		// a 的份额（500 MB）超过它的需要（占用 * 1.25 + 32 MB），多出的部分转给 b
+		for (unsigned int frame = 1; frame <= 2; ++frame) {
+			manager.update(&a, frame, 0.5, 100 * MB);
+			manager.update(&b, frame, 0.5, 4000 * MB);
+		}
+
+		const int64_t demand = static_cast<int64_t>(100 * MB * 1.25) + 32 * MB;
+		CHECK(manager.getBudget(&a).budget == demand);
+		CHECK(manager.getBudget(&b).budget == 1000 * MB - demand);
+	}
+
+	void testStaleTilesetDropsToFloor()
+	{
+		std::vector<Notification> log;
+		czmosg::CacheBudgetManager manager(1000 * MB);
+		manager.setMinimumBytes(100 * MB);
+
+		TestTileset a{ "a", &log };
+		TestTileset b{ "b", &log };
+		a.add(manager);
+		b.add(manager);
+
+		for (unsigned int frame = 1; frame <= 2; ++frame) {
+			manager.update(&a, frame, 0.5, 4000 * MB);
+			manager.update(&b, frame, 0.5, 4000 * MB);
+		}
+		CHECK(manager.getBudget(&b).budget > 100 * MB);
+
+		// b 不再被遍历：超过 10 帧后只保留保底预算，并收到 updated 为 false 的回调
+		unsigned int frame = 3;
+		for (; frame <= 20; ++frame) {
+			manager.update(&a, frame, 0.5, 4000 * MB);
+		}
+		CHECK(manager.getBudget(&b).budget == 100 * MB);
+		CHECK(manager.getBudget(&a).budget == 900 * MB);
+		CHECK(!log.empty());
+
+		bool notifiedAtFloor = false;
+		for (const Notification& notification : log) {
+			if (notification.tileset == "b" && notification.budget == 100 * MB) {
+				CHECK(!notification.updated);
+				notifiedAtFloor = true;
+			}
+		}
+		CHECK(notifiedAtFloor);
+
+		// 预算不再变化后，不再遍历的瓦片集不会每帧收到回调
+		const size_t notifications = countNotifications(log, "b");
+		for (; frame <= 60; ++frame) {
+			manager.update(&a, frame, 0.5, 4000 * MB);
+		}
+		CHECK(countNotifications(log, "b") == notifications);
+	}
+
+	void testCallbackOrderByValue()
+	{
+		std::vector<Notification> log;
+		czmosg::CacheBudgetManager manager(1000 * MB);
+		manager.setMinimumBytes(0);
+
+		TestTileset low{ "low", &log };
+		TestTileset high{ "high", &log };
+		low.add(manager);
+		high.add(manager);
+
+		// 价值 = 贡献 / 占用：low 占用多、贡献小，high 相反
+		unsigned int frame = 1;
+		for (; frame <= 2; ++frame) {
+			manager.update(&high, frame, 0.9, 3000 * MB);
+			manager.update(&low, frame, 0.1, 5000 * MB);
+		}
+
+		// 总预算减半，两个瓦片集的预算同时变化，价值低的先回调
+		log.clear();
+		manager.setTotalBytes(500 * MB);
+		manager.update(&high, frame, 0.9, 3000 * MB);
+
+		CHECK(log.size() == 2);
+		CHECK(log[0].tileset == "low");
+		CHECK(log[1].tileset == "high");
+		CHECK(log[0].budget < log[1].budget);
+	}
+}
+
+int main()
+{
+	czmosg::initializeLogger();
+
+	testSplitByContribution();
+	testRedistributeLeftover();
+	testStaleTilesetDropsToFloor();
+	testCallbackOrderByValue();
+
+	CO_INFO("CacheBudgetManagerTest passed");
+	return 0;
+}
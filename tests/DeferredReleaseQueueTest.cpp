@@ -0,0 +1,116 @@
+#include "TestCheck.h"
+
+#include "DeferredReleaseQueue.h"
+#include "Log.h"
+
+#include <osg/Geode>
+#include <osg/Material>
+#include <osg/StateSet>
+#include <osg/Texture2D>
+#include <osg/observer_ptr>
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	void advanceFrames(czmosg::DeferredReleaseQueue& queue, unsigned int frames)
+	{
+		for (unsigned int i = 0; i < frames; ++i) {
+			queue.advanceFrame();
+		}
+	}
+
+	// 等待后台线程析构完已交给它的条目
+	bool waitForReleased(const czmosg::DeferredReleaseQueue& queue, uint64_t released)
+	{
+		for (int i = 0; i < 200; ++i) {
+			if (queue.getStatistics().released >= released) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return false;
+	}
+
+	// 瓦片独占的 StateSet，引用与其它瓦片共享的材质和纹理
+	osg::ref_ptr<osg::Geode> createTileNode(osg::Material* sharedMaterial, osg::Texture2D* sharedTexture)
+	{
+		osg::ref_ptr<osg::Geode> node = new osg::Geode;
+		osg::StateSet* stateSet = node->getOrCreateStateSet();
+		stateSet->setAttributeAndModes(sharedMaterial);
+		stateSet->setTextureAttributeAndModes(0, sharedTexture);
+		return node;
+	}
+
+	void testReferencedNodeKeepsState()
+	{
+		osg::ref_ptr<osg::Material> sharedMaterial = new osg::Material;
+		osg::ref_ptr<osg::Texture2D> sharedTexture = new osg::Texture2D;
+		osg::ref_ptr<osg::StateSet> otherTile = new osg::StateSet;
+		otherTile->setAttributeAndModes(sharedMaterial.get());
+		otherTile->setTextureAttributeAndModes(0, sharedTexture.get());
+
+		// 节点入队后仍被其它对象引用（例如仍在渲染列表中）
+		osg::ref_ptr<osg::Geode> node = createTileNode(sharedMaterial.get(), sharedTexture.get());
+		osg::StateSet* stateSet = node->getStateSet();
+
+		czmosg::DeferredReleaseQueue queue;
+		queue.push(node.get());
+		advanceFrames(queue, czmosg::DeferredReleaseQueue::DELAY_FRAMES);
+
+		// 到期后只释放队列的引用，StateSet 及其中的共享属性保持不变
+		CHECK(node->referenceCount() == 1);
+		CHECK(node->getStateSet() == stateSet);
+		CHECK(stateSet->getAttribute(osg::StateAttribute::MATERIAL) == sharedMaterial.get());
+		CHECK(stateSet->getTextureAttribute(0, osg::StateAttribute::TEXTURE) == sharedTexture.get());
+		CHECK(sharedMaterial->getNumParents() == 2);
+
+		czmosg::DeferredReleaseQueue::Statistics statistics = queue.getStatistics();
+		CHECK(statistics.queued == 1);
+		CHECK(statistics.released == 1);
+		CHECK(statistics.pending == 0);
+	}
+
+	void testUnreferencedNodeIsDetachedAndReleased()
+	{
+		osg::ref_ptr<osg::Material> sharedMaterial = new osg::Material;
+		osg::ref_ptr<osg::Texture2D> sharedTexture = new osg::Texture2D;
+		osg::ref_ptr<osg::StateSet> otherTile = new osg::StateSet;
+		otherTile->setAttributeAndModes(sharedMaterial.get());
+		otherTile->setTextureAttributeAndModes(0, sharedTexture.get());
+
+		osg::observer_ptr<osg::Geode> observer;
+		czmosg::DeferredReleaseQueue queue;
+		{
+			osg::ref_ptr<osg::Geode> node = createTileNode(sharedMaterial.get(), sharedTexture.get());
+			observer = node.get();
+			queue.push(node.get());
+		}
+		CHECK(observer.valid());
+
+		// 未到期前不处理
+		advanceFrames(queue, czmosg::DeferredReleaseQueue::DELAY_FRAMES - 1);
+		CHECK(observer.valid());
+		CHECK(sharedMaterial->getNumParents() == 2);
+
+		// 到期后在主线程中摘除共享属性，再由后台线程析构
+		queue.advanceFrame();
+		CHECK(sharedMaterial->getNumParents() == 1);
+		CHECK(sharedTexture->getNumParents() == 1);
+		CHECK(waitForReleased(queue, 1));
+		CHECK(!observer.valid());
+		CHECK(queue.getStatistics().pending == 0);
+	}
+}
+
+int main()
+{
+	czmosg::initializeLogger();
+
+	testReferencedNodeKeepsState();
+	testUnreferencedNodeIsDetachedAndReleased();
+
+	CO_INFO("DeferredReleaseQueueTest passed");
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include "TestCheck.h"
+
+#include "Log.h"
+#include "MeshOptimizer.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// 规则网格上的三角形，按固定种子打乱顺序，使顶点缓存几乎无法命中
+	osg::ref_ptr<osg::Geometry> createShuffledGrid(unsigned int size)
+	{
+		osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+		for (unsigned int y = 0; y < size; ++y) {
+			for (unsigned int x = 0; x < size; ++x) {
+				vertices->push_back(osg::Vec3(float(x), float(y), 0.0f));
+			}
+		}
+
+		std::vector<std::array<unsigned short, 3>> triangles;
+		for (unsigned int y = 0; y + 1 < size; ++y) {
+			for (unsigned int x = 0; x + 1 < size; ++x) {
+				const unsigned short i0 = static_cast<unsigned short>(y * size + x);
+				const unsigned short i1 = static_cast<unsigned short>(i0 + 1);
+				const unsigned short i2 = static_cast<unsigned short>(i0 + size);
+				const unsigned short i3 = static_cast<unsigned short>(i2 + 1);
+				triangles.push_back({ i0, i1, i3 });
+				triangles.push_back({ i0, i3, i2 });
+			}
+		}
+		std::mt19937 random(12345);
+		std::shuffle(triangles.begin(), triangles.end(), random);
+
+		osg::ref_ptr<osg::DrawElementsUShort> indices = new osg::DrawElementsUShort(GL_TRIANGLES);
+		for (const auto& triangle : triangles) {
+			indices->insert(indices->end(), triangle.begin(), triangle.end());
+		}
+
+		osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+		geometry->setVertexArray(vertices.get());
+		geometry->addPrimitiveSet(indices.get());
+		return geometry;
+	}
+
+	void testOptimizeReducesCacheMisses()
+	{
+		osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+		geode->addDrawable(createShuffledGrid(32).get());
+
+		const uint64_t trianglesBefore = czmosg::countTriangles(geode.get());
+		CHECK(trianglesBefore == 2 * 31 * 31);
+
+		czmosg::VertexCacheStatistics statistics = czmosg::optimizeVertexCache(geode.get());
+		CHECK(statistics.geometries == 1);
+		CHECK(statistics.triangles == trianglesBefore);
+		CHECK(statistics.acmrAfter() < statistics.acmrBefore());
+
+		// 只重排三角形和顶点，不增删三角形
+		CHECK(czmosg::countTriangles(geode.get()) == trianglesBefore);
+	}
+
+	void testNonTriangleGeometryUnchanged()
+	{
+		osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+		osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+		vertices->push_back(osg::Vec3(0.0f, 0.0f, 0.0f));
+		vertices->push_back(osg::Vec3(1.0f, 0.0f, 0.0f));
+		geometry->setVertexArray(vertices.get());
+		geometry->addPrimitiveSet(new osg::DrawArrays(GL_LINES, 0, 2));
+
+		czmosg::VertexCacheStatistics statistics = czmosg::optimizeVertexCache(*geometry);
+		CHECK(statistics.geometries == 0);
+		CHECK(geometry->getVertexArray() == vertices.get());
+	}
+}
+
+int main()
+{
+	czmosg::initializeLogger();
+
+	testOptimizeReducesCacheMisses();
+	testNonTriangleGeometryUnchanged();
+
+	CO_INFO("MeshOptimizerTest passed");
+	return 0;
+}
@@ -0,0 +1,164 @@
+#include "TestCheck.h"
+
+#include "Log.h"
+#include "NodeBuilder.h"
+
+#include <CesiumGltf/Model.h>
+
+#include <osg/Node>
+
+#include <glm/mat4x4.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+// 统计本程序中的堆分配次数（Windows 上 OSG 动态库内部的分配不经过这里，只比较同一程序中的差值）
+namespace
+{
+	std::atomic<uint64_t> g_allocations{ 0 };
+}
+
+void* operator new(std::size_t size)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+namespace
+{
+	// 每个图元允许的堆分配次数上限
+	constexpr uint64_t MAX_ALLOCATIONS_PER_PRIMITIVE = 24;
+
+	// primitiveCount 个三角形图元，共用 gridSize x gridSize 个顶点的网格和 16 位索引
+	CesiumGltf::Model createGridModel(unsigned int primitiveCount, unsigned int gridSize)
+	{
+		using namespace CesiumGltf;
+
+		std::vector<float> positions;
+		for (unsigned int y = 0; y < gridSize; ++y) {
+			for (unsigned int x = 0; x < gridSize; ++x) {
+				positions.insert(positions.end(), { float(x), float(y), 0.0f });
+			}
+		}
+
+		std::vector<uint16_t> indices;
+		for (unsigned int y = 0; y + 1 < gridSize; ++y) {
+			for (unsigned int x = 0; x + 1 < gridSize; ++x) {
+				const uint16_t i0 = static_cast<uint16_t>(y * gridSize + x);
+				const uint16_t i2 = static_cast<uint16_t>(i0 + gridSize);
+				indices.insert(indices.end(), { i0, uint16_t(i0 + 1), uint16_t(i2 + 1), i0, uint16_t(i2 + 1), i2 });
+			}
+		}
+
+		const size_t positionBytes = positions.size() * sizeof(float);
+		const size_t indexBytes = indices.size() * sizeof(uint16_t);
+
+		Model model;
+
+		Buffer& buffer = model.buffers.emplace_back();
+		buffer.cesium.data.resize(positionBytes + indexBytes);
+		std::memcpy(buffer.cesium.data.data(), positions.data(), positionBytes);
+		std::memcpy(buffer.cesium.data.data() + positionBytes, indices.data(), indexBytes);
+		buffer.byteLength = static_cast<int64_t>(buffer.cesium.data.size());
+
+		BufferView& positionView = model.bufferViews.emplace_back();
+		positionView.buffer = 0;
+		positionView.byteLength = static_cast<int64_t>(positionBytes);
+
+		BufferView& indexView = model.bufferViews.emplace_back();
+		indexView.buffer = 0;
+		indexView.byteOffset = static_cast<int64_t>(positionBytes);
+		indexView.byteLength = static_cast<int64_t>(indexBytes);
+
+		Accessor& positionAccessor = model.accessors.emplace_back();
+		positionAccessor.bufferView = 0;
+		positionAccessor.componentType = Accessor::ComponentType::FLOAT;
+		positionAccessor.type = Accessor::Type::VEC3;
+		positionAccessor.count = gridSize * gridSize;
+
+		Accessor& indexAccessor = model.accessors.emplace_back();
+		indexAccessor.bufferView = 1;
+		indexAccessor.componentType = Accessor::ComponentType::UNSIGNED_SHORT;
+		indexAccessor.type = Accessor::Type::SCALAR;
+		indexAccessor.count = static_cast<int64_t>(indices.size());
+
+		model.materials.emplace_back().pbrMetallicRoughness.emplace();
+
+		Mesh& mesh = model.meshes.emplace_back();
+		for (unsigned int i = 0; i < primitiveCount; ++i) {
+			MeshPrimitive& primitive = mesh.primitives.emplace_back();
+			primitive.attributes["POSITION"] = 0;
+			primitive.indices = 1;
+			primitive.material = 0;
+		}
+
+		model.nodes.emplace_back().mesh = 0;
+		model.scenes.emplace_back().nodes.push_back(0);
+		model.scene = 0;
+		return model;
+	}
+
+	// 转换模型期间的堆分配次数（不含模型本身的构造）
+	uint64_t countBuildAllocations(unsigned int primitiveCount, unsigned int gridSize)
+	{
+		CesiumGltf::Model model = createGridModel(primitiveCount, gridSize);
+		czmosg::NodeBuilder builder(&model, glm::dmat4(1.0));
+
+		const uint64_t before = g_allocations.load(std::memory_order_relaxed);
+		osg::ref_ptr<osg::Node> node = builder.build();
+		const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+
+		CHECK(node.valid());
+		return allocations;
+	}
+
+	void testAllocationsIndependentOfAccessorSize()
+	{
+		// 数组和 DrawElements 按访问器的元素数一次分配，分配次数不随顶点数和索引数增长
+		const uint64_t small = countBuildAllocations(4, 4);
+		const uint64_t large = countBuildAllocations(4, 128);
+		CO_INFO("NodeBuilder allocations for 4 primitives: {} (16 vertices), {} (16384 vertices)", small, large);
+		CHECK(small == large);
+	}
+
+	void testAllocationsPerPrimitive()
+	{
+		const uint64_t four = countBuildAllocations(4, 16);
+		const uint64_t eight = countBuildAllocations(8, 16);
+		CHECK(eight > four);
+
+		// 每个图元只有固定的几次分配（Geode、Geometry、顶点数组、DrawElements 及其存储、父节点列表等），
+		// 另有子节点列表按倍数扩容的少量分配
+		const uint64_t perPrimitive = (eight - four) / 4;
+		CO_INFO("NodeBuilder allocations per primitive: {}", perPrimitive);
+		CHECK(perPrimitive <= MAX_ALLOCATIONS_PER_PRIMITIVE);
+	}
+}
+
+int main()
+{
+	czmosg::initializeLogger();
+
+	testAllocationsIndependentOfAccessorSize();
+	testAllocationsPerPrimitive();
+
+	CO_INFO("NodeBuilderAllocationTest passed");
+	return 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// 条件不成立时输出位置并以失败状态退出（由 ctest 判定失败）
+#define CHECK(condition)                                                                      \
+	do {                                                                                      \
+		if (!(condition)) {                                                                   \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			std::exit(EXIT_FAILURE);                                                          \
+		}                                                                                     \
+	} while (0)
@@ -0,0 +1,291 @@
+#include "TestCheck.h"
+
+#include "Log.h"
+#include "NodeBuilder.h"
+#include "TextureCache.h"
+
+#include <CesiumGltf/ImageAsset.h>
+#include <CesiumGltf/Model.h>
+
+#include <osg/Material>
+#include <osg/Node>
+#include <osg/StateSet>
+#include <osg/Texture2D>
+
+#include <glm/mat4x4.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset> createImageAsset(std::byte seed, int32_t width = 4, int32_t height = 4)
+	{
+		CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset> asset = new CesiumGltf::ImageAsset();
+		asset->width = width;
+		asset->height = height;
+		asset->channels = 4;
+		asset->bytesPerChannel = 1;
+		asset->pixelData.resize(size_t(width) * height * 4);
+		for (size_t i = 0; i < asset->pixelData.size(); ++i) {
+			asset->pixelData[i] = static_cast<std::byte>(i) ^ seed;
+		}
+		return asset;
+	}
+
+	// 一个带基础颜色纹理的三角形
+	CesiumGltf::Model createTexturedModel(std::byte seed)
+	{
+		using namespace CesiumGltf;
+
+		const float positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+		const float texCoords[] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f };
+
+		Model model;
+
+		Buffer& buffer = model.buffers.emplace_back();
+		buffer.cesium.data.resize(sizeof(positions) + sizeof(texCoords));
+		std::memcpy(buffer.cesium.data.data(), positions, sizeof(positions));
+		std::memcpy(buffer.cesium.data.data() + sizeof(positions), texCoords, sizeof(texCoords));
+		buffer.byteLength = static_cast<int64_t>(buffer.cesium.data.size());
+
+		BufferView& positionView = model.bufferViews.emplace_back();
+		positionView.buffer = 0;
+		positionView.byteLength = sizeof(positions);
+
+		BufferView& texCoordView = model.bufferViews.emplace_back();
+		texCoordView.buffer = 0;
+		texCoordView.byteOffset = sizeof(positions);
+		texCoordView.byteLength = sizeof(texCoords);
+
+		Accessor& positionAccessor = model.accessors.emplace_back();
+		positionAccessor.bufferView = 0;
+		positionAccessor.componentType = Accessor::ComponentType::FLOAT;
+		positionAccessor.type = Accessor::Type::VEC3;
+		positionAccessor.count = 3;
+
+		Accessor& texCoordAccessor = model.accessors.emplace_back();
+		texCoordAccessor.bufferView = 1;
+		texCoordAccessor.componentType = Accessor::ComponentType::FLOAT;
+		texCoordAccessor.type = Accessor::Type::VEC2;
+		texCoordAccessor.count = 3;
+
+		model.images.emplace_back().pAsset = createImageAsset(seed);
+		model.textures.emplace_back().source = 0;
+
+		Material& material = model.materials.emplace_back();
+		material.pbrMetallicRoughness.emplace().baseColorTexture.emplace().index = 0;
+
+		MeshPrimitive& primitive = model.meshes.emplace_back().primitives.emplace_back();
+		primitive.attributes["POSITION"] = 0;
+		primitive.attributes["TEXCOORD_0"] = 1;
+		primitive.material = 0;
+
+		model.nodes.emplace_back().mesh = 0;
+		model.scenes.emplace_back().nodes.push_back(0);
+		model.scene = 0;
+		return model;
+	}
+
+	void testCacheKey()
+	{
+		auto a = createImageAsset(std::byte{ 0 });
+		auto b = createImageAsset(std::byte{ 0 });
+		auto c = createImageAsset(std::byte{ 1 });
+
+		czmosg::TextureSamplerState sampler;
+		czmosg::TextureSamplerState nearest;
+		nearest.magFilter = osg::Texture::NEAREST;
+
+		const czmosg::TextureCacheKey keyA = czmosg::TextureCacheKey::create(*a, sampler);
+		const czmosg::TextureCacheKey keyB = czmosg::TextureCacheKey::create(*b, sampler);
+		CHECK(keyA == keyB);
+		CHECK(czmosg::TextureCacheKeyHash{}(keyA) == czmosg::TextureCacheKeyHash{}(keyB));
+
+		// 像素或采样状态不同都不能共享
+		CHECK(!(keyA == czmosg::TextureCacheKey::create(*c, sampler)));
+		CHECK(!(keyA == czmosg::TextureCacheKey::create(*a, nearest)));
+	}
+
+	void testCacheHit()
+	{
+		auto asset = createImageAsset(std::byte{ 0 });
+		auto other = createImageAsset(std::byte{ 1 });
+		const czmosg::TextureCacheKey key = czmosg::TextureCacheKey::create(*asset, {});
+
+		czmosg::TextureCache cache;
+		CHECK(!cache.find(key, asset->pixelData).valid());
+
+		osg::ref_ptr<osg::Image> image = new osg::Image;
+		image->allocateImage(asset->width, asset->height, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+		std::memcpy(image->data(), asset->pixelData.data(), asset->pixelData.size());
+		osg::ref_ptr<osg::Texture2D> texture = new osg::Texture2D(image.get());
+		cache.insert(key, texture.get());
+
+		CHECK(cache.find(key, asset->pixelData) == texture);
+
+		// 键相同但像素不同（哈希冲突）时不共享
+		CHECK(!cache.find(key, other->pixelData).valid());
+
+		czmosg::TextureCache::Statistics statistics = cache.getStatistics();
+		CHECK(statistics.hits == 1);
+		CHECK(statistics.misses == 2);
+		CHECK(statistics.bytesSaved == asset->pixelData.size());
+		CHECK(statistics.entries == 1);
+
+		// 缓存只弱引用纹理，释放后不再命中
+		texture = nullptr;
+		CHECK(!cache.find(key, asset->pixelData).valid());
+		CHECK(cache.getStatistics().entries == 0);
+	}
+
+	void testNodeBuilderBindsCachedTexturesLater()
+	{
+		czmosg::TextureCache cache;
+
+		CesiumGltf::Model firstModel = createTexturedModel(std::byte{ 0 });
+		czmosg::NodeBuilder firstBuilder(&firstModel, glm::dmat4(1.0));
+		firstBuilder.setTextureCache(&cache);
+		osg::ref_ptr<osg::Node> firstNode = firstBuilder.build();
+		CHECK(firstNode.valid());
+
+		// 登记到缓存的纹理不在加载线程中挂接
+		czmosg::SharedStateBindings firstBindings = firstBuilder.takeSharedStateBindings();
+		CHECK(firstBindings.textures.size() == 1);
+		osg::ref_ptr<osg::StateSet> firstStateSet = firstBindings.textures[0].first;
+		osg::ref_ptr<osg::Texture2D> texture = firstBindings.textures[0].second;
+		CHECK(firstStateSet->getTextureAttribute(0, osg::StateAttribute::TEXTURE) == nullptr);
+		CHECK(firstStateSet->getTextureMode(0, GL_TEXTURE_2D) & osg::StateAttribute::ON);
+		CHECK(texture->getNumParents() == 0);
+
+		firstBindings.bind();
+		CHECK(firstBindings.empty());
+		CHECK(firstStateSet->getTextureAttribute(0, osg::StateAttribute::TEXTURE) == texture.get());
+
+		// 像素相同的第二个模型命中缓存，同样推迟到 bind() 才挂接
+		CesiumGltf::Model secondModel = createTexturedModel(std::byte{ 0 });
+		czmosg::NodeBuilder secondBuilder(&secondModel, glm::dmat4(1.0));
+		secondBuilder.setTextureCache(&cache);
+		osg::ref_ptr<osg::Node> secondNode = secondBuilder.build();
+		CHECK(secondNode.valid());
+		CHECK(secondBuilder.getStatistics().texturesSharedAcrossTiles == 1);
+		CHECK(cache.getStatistics().hits == 1);
+
+		czmosg::SharedStateBindings secondBindings = secondBuilder.takeSharedStateBindings();
+		CHECK(secondBindings.textures.size() == 1);
+		CHECK(secondBindings.textures[0].second == texture);
+		CHECK(texture->getNumParents() == 1);
+
+		secondBindings.bind();
+		CHECK(texture->getNumParents() == 2);
+
+		// 共享纹理替代了第二个模型的像素数据
+		CHECK(!secondModel.images[0].pAsset);
+		CHECK(firstModel.images[0].pAsset);
+	}
+
+	void testTileRenderState()
+	{
+		CesiumGltf::Model model = createTexturedModel(std::byte{ 0 });
+		model.materials[0].pbrMetallicRoughness->baseColorFactor = { 0.5, 0.25, 1.0, 1.0 };
+		model.materials[0].doubleSided = true;
+
+		czmosg::NodeBuilder builder(&model, glm::dmat4(1.0));
+		builder.setTileRenderState(true);
+		osg::ref_ptr<osg::Node> node = builder.build();
+		CHECK(node.valid());
+		CHECK(builder.getStateSets().size() == 1);
+
+		// 双面材质不剔除背面，基础颜色保持线性值，材质不覆盖下层状态
+		const osg::StateSet* stateSet = builder.getStateSets().begin()->second.get();
+		CHECK(stateSet->getMode(GL_CULL_FACE) == osg::StateAttribute::INHERIT);
+		const osg::StateSet::RefAttributePair* materialPair = stateSet->getAttributePair(osg::StateAttribute::MATERIAL);
+		CHECK(materialPair != nullptr);
+		CHECK(!(materialPair->second & osg::StateAttribute::OVERRIDE));
+		const osg::Material* material = static_cast<const osg::Material*>(materialPair->first.get());
+		CHECK(material->getDiffuse(osg::Material::FRONT) == osg::Vec4(0.5f, 0.25f, 1.0f, 1.0f));
+
+		// 单面材质开启背面剔除
+		CesiumGltf::Model singleSidedModel = createTexturedModel(std::byte{ 0 });
+		czmosg::NodeBuilder singleSidedBuilder(&singleSidedModel, glm::dmat4(1.0));
+		singleSidedBuilder.setTileRenderState(true);
+		osg::ref_ptr<osg::Node> singleSidedNode = singleSidedBuilder.build();
+		CHECK(singleSidedBuilder.getStateSets().begin()->second->getMode(GL_CULL_FACE) & osg::StateAttribute::ON);
+	}
+
+	// 宽高比悬殊的图像缩小时，较短的一边按实际像素数取平均，不读越界
+	void testDownscaleExtremeAspectRatio()
+	{
+		const int32_t sizes[][2] = { { 64, 2 }, { 2, 64 }, { 66, 3 } };
+		for (const auto& size : sizes) {
+			CesiumGltf::Model model = createTexturedModel(std::byte{ 0 });
+			auto asset = createImageAsset(std::byte{ 0 }, size[0], size[1]);
+			std::fill(asset->pixelData.begin(), asset->pixelData.end(), std::byte{ 100 });
+			model.images[0].pAsset = asset;
+
+			czmosg::NodeBuilder builder(&model, glm::dmat4(1.0));
+			builder.setMaximumTextureSize(16);
+			osg::ref_ptr<osg::Node> node = builder.build();
+			CHECK(node.valid());
+			CHECK(builder.getStatistics().texturesDownscaled == 1);
+			CHECK(builder.getStateSets().size() == 1);
+
+			const osg::StateSet* stateSet = builder.getStateSets().begin()->second.get();
+			const osg::Texture2D* texture = dynamic_cast<const osg::Texture2D*>(
+				stateSet->getTextureAttribute(0, osg::StateAttribute::TEXTURE));
+			CHECK(texture && texture->getImage());
+			const osg::Image* image = texture->getImage();
+			CHECK(image->s() <= 16 && image->t() <= 16);
+			CHECK(image->s() >= 1 && image->t() >= 1);
+
+			// 像素全部相同，平均值不变
+			const unsigned char* pixels = image->data();
+			for (unsigned int i = 0; i < image->getTotalSizeInBytes(); ++i) {
+				CHECK(pixels[i] == 100);
+			}
+		}
+	}
+
+	void testDownscaledTexturesNotCached()
+	{
+		czmosg::TextureCache cache;
+
+		// 缩小后的纹理不能以全分辨率图像的键登记
+		CesiumGltf::Model downscaledModel = createTexturedModel(std::byte{ 0 });
+		czmosg::NodeBuilder downscaledBuilder(&downscaledModel, glm::dmat4(1.0));
+		downscaledBuilder.setTextureCache(&cache);
+		downscaledBuilder.setMaximumTextureSize(2);
+		osg::ref_ptr<osg::Node> downscaledNode = downscaledBuilder.build();
+		CHECK(downscaledNode.valid());
+		CHECK(downscaledBuilder.getStatistics().texturesDownscaled == 1);
+		CHECK(downscaledBuilder.takeSharedStateBindings().textures.empty());
+		CHECK(cache.getStatistics().entries == 0);
+
+		// 不限制尺寸的模型仍然创建全分辨率纹理
+		CesiumGltf::Model fullModel = createTexturedModel(std::byte{ 0 });
+		czmosg::NodeBuilder fullBuilder(&fullModel, glm::dmat4(1.0));
+		fullBuilder.setTextureCache(&cache);
+		osg::ref_ptr<osg::Node> fullNode = fullBuilder.build();
+		CHECK(fullNode.valid());
+		CHECK(fullBuilder.getStatistics().texturesSharedAcrossTiles == 0);
+		czmosg::SharedStateBindings bindings = fullBuilder.takeSharedStateBindings();
+		CHECK(bindings.textures.size() == 1);
+		CHECK(bindings.textures[0].second->getImage()->s() == 4);
+	}
+}
+
+int main()
+{
+	czmosg::initializeLogger();
+
+	testCacheKey();
+	testCacheHit();
+	testNodeBuilderBindsCachedTexturesLater();
+	testTileRenderState();
+	testDownscaleExtremeAspectRatio();
+	testDownscaledTexturesNotCached();
+
+	CO_INFO("TextureCacheTest passed");
+	return 0;
+}